@@ -0,0 +1,732 @@
+/*
+ * cascade_filter.cpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ */
+
+#include "cascade_filter.hpp"
+#include "simd.hpp"
+
+using namespace std;
+
+constexpr unsigned int CascadeFilter::chunk_size;
+
+/* # ストリーミングフィルタ
+ *   コンストラクタ
+ *   係数列を分子・分母の節に分け，先頭から順に組にして2次の節を作る
+ *
+ * # 引数
+ * FilterParam& fparam : 係数列の次数を与えるフィルタパラメータ
+ * vector<double> coef : 係数列(a0, a1, a2[0], a2[1],..., b1, b2[0], b2[1],...)
+ */
+CascadeFilter::CascadeFilter(const FilterParam& fparam, const vector<double>& coef)
+{
+	const unsigned int n_order = fparam.zero_order();
+	const unsigned int m_order = fparam.pole_order();
+	if (coef.size() != fparam.opt_order())
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, coef.size(), fparam.opt_order());
+		exit(EXIT_FAILURE);
+	}
+
+	const unsigned int nzero = (n_order + 1)/2;
+	const unsigned int npole = (m_order + 1)/2;
+	sections.resize(max(1u, max(nzero, npole)));
+
+	// 分子の節
+	unsigned int n = 1;
+	for (unsigned int k = 0; k < nzero; ++k)
+	{
+		if (k == 0 && n_order % 2 == 1)
+		{
+			sections[k].b1 = coef[n];
+			n += 1;
+		}
+		else
+		{
+			sections[k].b1 = coef[n];
+			sections[k].b2 = coef[n + 1];
+			n += 2;
+		}
+	}
+
+	// 分母の節
+	unsigned int m = n_order + 1;
+	for (unsigned int k = 0; k < npole; ++k)
+	{
+		if (k == 0 && m_order % 2 == 1)
+		{
+			sections[k].a1 = coef[m];
+			m += 1;
+		}
+		else
+		{
+			sections[k].a1 = coef[m];
+			sections[k].a2 = coef[m + 1];
+			m += 2;
+		}
+	}
+
+	// 利得は先頭の節の分子に掛ける
+	sections[0].b0 *= coef[0];
+	sections[0].b1 *= coef[0];
+	sections[0].b2 *= coef[0];
+}
+
+/* # ストリーミングフィルタ
+ *   全ての節の状態を0に戻す
+ */
+void CascadeFilter::reset()
+{
+	for (auto& sec : sections)
+	{
+		sec.s1 = 0.0;
+		sec.s2 = 0.0;
+	}
+}
+
+/* # ストリーミングフィルタ
+ *   1点を処理して出力を返す
+ */
+double CascadeFilter::process(const double input)
+{
+	double x = input;
+	for (auto& sec : sections)
+	{
+		const double y = sec.b0*x + sec.s1;
+		sec.s1 = sec.b1*x - sec.a1*y + sec.s2;
+		sec.s2 = sec.b2*x - sec.a2*y;
+		x = y;
+	}
+	return x;
+}
+
+/* # ストリーミングフィルタ
+ *   n点の信号dataに節の列をその場で適用する
+ *   節の係数と状態をレジスタに置いて全点を処理し次の節へ進む
+ *   1つの節の漸化式は直前の出力を待つ積和の連鎖になるため，
+ *   2つの節を同じループで処理して互いの待ち時間を埋める
+ */
+static void cascade_sections(vector<BiquadSection>& sections, double* data, const size_t n)
+{
+	const unsigned int nsec = sections.size();
+	unsigned int k = 0;
+	for (; k + 1 < nsec; k += 2)
+	{
+		BiquadSection& p = sections[k];
+		BiquadSection& q = sections[k + 1];
+		const double pb0 = p.b0, pb1 = p.b1, pb2 = p.b2, pa1 = p.a1, pa2 = p.a2;
+		const double qb0 = q.b0, qb1 = q.b1, qb2 = q.b2, qa1 = q.a1, qa2 = q.a2;
+		double ps1 = p.s1, ps2 = p.s2;
+		double qs1 = q.s1, qs2 = q.s2;
+		for (size_t i = 0; i < n; ++i)
+		{
+			const double x = data[i];
+			const double u = pb0*x + ps1;
+			ps1 = pb1*x - pa1*u + ps2;
+			ps2 = pb2*x - pa2*u;
+			const double y = qb0*u + qs1;
+			qs1 = qb1*u - qa1*y + qs2;
+			qs2 = qb2*u - qa2*y;
+			data[i] = y;
+		}
+		p.s1 = ps1;
+		p.s2 = ps2;
+		q.s1 = qs1;
+		q.s2 = qs2;
+	}
+	if (k < nsec)
+	{
+		BiquadSection& p = sections[k];
+		const double b0 = p.b0, b1 = p.b1, b2 = p.b2, a1 = p.a1, a2 = p.a2;
+		double s1 = p.s1, s2 = p.s2;
+		for (size_t i = 0; i < n; ++i)
+		{
+			const double x = data[i];
+			const double y = b0*x + s1;
+			s1 = b1*x - a1*y + s2;
+			s2 = b2*x - a2*y;
+			data[i] = y;
+		}
+		p.s1 = s1;
+		p.s2 = s2;
+	}
+}
+
+/* # ストリーミングフィルタ
+ *   長さlengthの信号dataをその場で処理する
+ *   chunk_size点の区間ごとに全ての節を適用する
+ */
+void CascadeFilter::process(double* data, const size_t length)
+{
+	for (size_t begin = 0; begin < length; begin += chunk_size)
+	{
+		cascade_sections(sections, data + begin, min(length - begin, (size_t)chunk_size));
+	}
+}
+
+void CascadeFilter::process(vector<double>& data)
+{
+	process(data.data(), data.size());
+}
+
+constexpr size_t CascadeFilter::parallel_block_min;
+constexpr double CascadeFilter::parallel_tail_eps;
+
+/* # ストリーミングフィルタ
+ *   長さlengthの信号dataをブロックに分け，スレッドプールで並列にその場で処理する
+ *   縦続接続全体を2 x 節数個の状態を持つ線形系とみなし，次の3段階で計算する
+ *     1. 各ブロックを状態0から並列に処理し，出力と終端の状態を得る(先頭のブロックのみ現在の状態から)
+ *     2. ブロックの初期状態を先頭から順に求める
+ *          S[b + 1] = A^L S[b] + Z[b]   (Z[b]はブロックbを状態0から処理した終端の状態)
+ *     3. 各ブロックの出力に初期状態S[b]による零入力応答 Σ_j S[b][j] h_j を並列に加える
+ *   h_jは状態jのみ1とした零入力応答で，状態の大きさがparallel_tail_eps未満に減衰した点で打ち切る
+ *   安定なフィルタでは補正はブロックの先頭の数百～数千点だけで済み，段階1がほぼ全ての計算量となる
+ *
+ *   出力はprocessと加算の順序が異なるため，ビット単位では一致しない
+ *   誤差は出力の大きさに対して倍精度の丸め誤差程度(相対1e-12程度以下)で，
+ *   打ち切りによる誤差は入力の大きさのparallel_tail_eps倍程度
+ *   終了後の状態は逐次処理した場合と同じく次の呼び出しに引き継がれる
+ *   信号がparallel_block_minの2倍に満たない場合やプールが1スレッドの場合はprocessで処理する
+ *
+ * # 引数
+ * double* data : 信号(その場で出力に置き換える)
+ * size_t length : 信号の点数
+ * ThreadPool& pool : 使用するスレッドプール(省略時はプロセス共有のプール)
+ */
+void CascadeFilter::process_parallel(double* data, const size_t length, ThreadPool& pool)
+{
+	const size_t block = max(parallel_block_min, (length + 4*pool.size() - 1) / (4*pool.size()));
+	const size_t nblock = (length + block - 1) / block;
+	if (pool.size() == 1 || nblock < 2 || ThreadPool::in_worker())
+	{
+		process(data, length);
+		return;
+	}
+
+	const unsigned int nsec = sections.size();
+	const unsigned int nstate = 2*nsec;
+	const size_t last_length = length - (nblock - 1)*block;
+
+	// 段階1 : ブロックごとに状態0から処理し，終端の状態を記録する
+	vector<double> zero_state(nblock*nstate);
+	pool.parallel_for(0, nblock, 1,
+		[&](unsigned int begin, unsigned int end)
+		{
+			vector<BiquadSection> local = sections;
+			for (unsigned int b = begin; b < end; ++b)
+			{
+				if (b > 0)
+				{
+					for (auto& sec : local)
+					{
+						sec.s1 = 0.0;
+						sec.s2 = 0.0;
+					}
+				}
+				const size_t head = b*block;
+				const size_t n = min(block, length - head);
+				for (size_t i = 0; i < n; i += chunk_size)
+				{
+					cascade_sections(local, data + head + i, min(n - i, (size_t)chunk_size));
+				}
+				for (unsigned int k = 0; k < nsec; ++k)
+				{
+					zero_state[b*nstate + 2*k] = local[k].s1;
+					zero_state[b*nstate + 2*k + 1] = local[k].s2;
+				}
+			}
+		});
+
+	// 状態jのみ1とした零入力応答h_jと，block点後・last_length点後の状態(A^Lの列)
+	vector<double> response;		// response[i*nstate + j] = h_j[i]
+	vector<double> trans(nstate*nstate, 0.0);		// trans[i*nstate + j] = (A^block)_ij
+	vector<double> trans_last(nstate*nstate, 0.0);	// 最後のブロック用
+	size_t tail = 0;
+	for (unsigned int j = 0; j < nstate; ++j)
+	{
+		vector<BiquadSection> basis = sections;
+		for (auto& sec : basis)
+		{
+			sec.s1 = 0.0;
+			sec.s2 = 0.0;
+		}
+		(j % 2 == 0 ? basis[j/2].s1 : basis[j/2].s2) = 1.0;
+
+		for (size_t i = 0; i < block; ++i)
+		{
+			if (i == last_length)
+			{
+				for (unsigned int k = 0; k < nsec; ++k)
+				{
+					trans_last[(2*k)*nstate + j] = basis[k].s1;
+					trans_last[(2*k + 1)*nstate + j] = basis[k].s2;
+				}
+			}
+
+			double norm = 0.0;
+			for (const auto& sec : basis)
+			{
+				norm += abs(sec.s1) + abs(sec.s2);
+			}
+			if (norm < parallel_tail_eps)
+			{
+				break;
+			}
+
+			if (response.size() < (i + 1)*nstate)
+			{
+				response.resize((i + 1)*nstate, 0.0);
+			}
+			double x = 0.0;
+			for (auto& sec : basis)
+			{
+				const double y = sec.b0*x + sec.s1;
+				sec.s1 = sec.b1*x - sec.a1*y + sec.s2;
+				sec.s2 = sec.b2*x - sec.a2*y;
+				x = y;
+			}
+			response[i*nstate + j] = x;
+			tail = max(tail, i + 1);
+
+			if (i + 1 == block)
+			{
+				for (unsigned int k = 0; k < nsec; ++k)
+				{
+					trans[(2*k)*nstate + j] = basis[k].s1;
+					trans[(2*k + 1)*nstate + j] = basis[k].s2;
+				}
+			}
+		}
+	}
+
+	// 段階2 : ブロックの初期状態を順に求める(initial[b*nstate : (b + 1)*nstate))
+	vector<double> initial(nblock*nstate, 0.0);
+	for (size_t b = 0; b + 1 < nblock; ++b)
+	{
+		const double* s = &initial[b*nstate];
+		double* next = &initial[(b + 1)*nstate];
+		for (unsigned int i = 0; i < nstate; ++i)
+		{
+			double acc = zero_state[b*nstate + i];
+			if (b > 0)
+			{
+				for (unsigned int j = 0; j < nstate; ++j)
+				{
+					acc += trans[i*nstate + j]*s[j];
+				}
+			}
+			next[i] = acc;
+		}
+	}
+
+	// 最後のブロックの終端の状態を次の呼び出しに引き継ぐ
+	const double* s_last = &initial[(nblock - 1)*nstate];
+	const vector<double>& last = last_length == block ? trans : trans_last;
+	for (unsigned int k = 0; k < nsec; ++k)
+	{
+		double s[2];
+		for (unsigned int r = 0; r < 2; ++r)
+		{
+			const unsigned int i = 2*k + r;
+			double acc = zero_state[(nblock - 1)*nstate + i];
+			for (unsigned int j = 0; j < nstate; ++j)
+			{
+				acc += last[i*nstate + j]*s_last[j];
+			}
+			s[r] = acc;
+		}
+		sections[k].s1 = s[0];
+		sections[k].s2 = s[1];
+	}
+
+	// 段階3 : 初期状態による零入力応答を加える(先頭のブロックは補正不要)
+	pool.parallel_for(1, nblock, 1,
+		[&](unsigned int begin, unsigned int end)
+		{
+			for (unsigned int b = begin; b < end; ++b)
+			{
+				const double* s = &initial[b*nstate];
+				double* y = data + b*block;
+				const size_t n = min(tail, min(block, length - b*block));
+				for (size_t i = 0; i < n; ++i)
+				{
+					const double* h = &response[i*nstate];
+					double acc = 0.0;
+					for (unsigned int j = 0; j < nstate; ++j)
+					{
+						acc += h[j]*s[j];
+					}
+					y[i] += acc;
+				}
+			}
+		});
+}
+
+void CascadeFilter::process_parallel(vector<double>& data, ThreadPool& pool)
+{
+	process_parallel(data.data(), data.size(), pool);
+}
+
+constexpr unsigned int MultiCascadeFilter::chunk_size;
+
+/* # 多チャネルストリーミングフィルタ
+ *   V::width個のチャネルをn点処理する
+ *   data[i*stride + l]がレーンlのi点目で，状態は節kについてs1[k*nlane], s2[k*nlane]から
+ *   V::width個を読み書きする
+ *   1チャネルの場合と同じく，2つの節を同じループで処理して漸化式の待ち時間を埋める
+ */
+template<class V>
+static void cascade_lanes
+(const vector<BiquadSection>& sections, const unsigned int nlane,
+ double* s1, double* s2, double* data, const size_t stride, const size_t n)
+{
+	typedef typename V::reg reg;
+	const unsigned int nsec = sections.size();
+
+	unsigned int k = 0;
+	for (; k + 1 < nsec; k += 2)
+	{
+		const BiquadSection& p = sections[k];
+		const BiquadSection& q = sections[k + 1];
+		const reg pb0 = V::set1(p.b0), pb1 = V::set1(p.b1), pb2 = V::set1(p.b2);
+		const reg pa1 = V::set1(p.a1), pa2 = V::set1(p.a2);
+		const reg qb0 = V::set1(q.b0), qb1 = V::set1(q.b1), qb2 = V::set1(q.b2);
+		const reg qa1 = V::set1(q.a1), qa2 = V::set1(q.a2);
+		reg ps1 = V::load(s1 + k*nlane), ps2 = V::load(s2 + k*nlane);
+		reg qs1 = V::load(s1 + (k + 1)*nlane), qs2 = V::load(s2 + (k + 1)*nlane);
+		for (size_t i = 0; i < n; ++i)
+		{
+			const reg x = V::load(data + i*stride);
+			const reg u = V::fmadd(pb0, x, ps1);
+			ps1 = V::fnmadd(pa1, u, V::fmadd(pb1, x, ps2));
+			ps2 = V::fnmadd(pa2, u, V::mul(pb2, x));
+			const reg y = V::fmadd(qb0, u, qs1);
+			qs1 = V::fnmadd(qa1, y, V::fmadd(qb1, u, qs2));
+			qs2 = V::fnmadd(qa2, y, V::mul(qb2, u));
+			V::store(data + i*stride, y);
+		}
+		V::store(s1 + k*nlane, ps1);
+		V::store(s2 + k*nlane, ps2);
+		V::store(s1 + (k + 1)*nlane, qs1);
+		V::store(s2 + (k + 1)*nlane, qs2);
+	}
+	if (k < nsec)
+	{
+		const BiquadSection& p = sections[k];
+		const reg b0 = V::set1(p.b0), b1 = V::set1(p.b1), b2 = V::set1(p.b2);
+		const reg a1 = V::set1(p.a1), a2 = V::set1(p.a2);
+		reg ps1 = V::load(s1 + k*nlane), ps2 = V::load(s2 + k*nlane);
+		for (size_t i = 0; i < n; ++i)
+		{
+			const reg x = V::load(data + i*stride);
+			const reg y = V::fmadd(b0, x, ps1);
+			ps1 = V::fnmadd(a1, y, V::fmadd(b1, x, ps2));
+			ps2 = V::fnmadd(a2, y, V::mul(b2, x));
+			V::store(data + i*stride, y);
+		}
+		V::store(s1 + k*nlane, ps1);
+		V::store(s2 + k*nlane, ps2);
+	}
+}
+
+/* # 多チャネルストリーミングフィルタ
+ *   コンストラクタ
+ *
+ * # 引数
+ * FilterParam& fparam : 係数列の次数を与えるフィルタパラメータ
+ * vector<double> coef : 係数列(a0, a1, a2[0], a2[1],..., b1, b2[0], b2[1],...)
+ * unsigned int nchannel : チャネル数
+ */
+MultiCascadeFilter::MultiCascadeFilter
+(const FilterParam& fparam, const vector<double>& coef, const unsigned int nchannel)
+:channel(nchannel)
+{
+	if (nchannel == 0)
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Number of channel must be positive.(nchannel : %u)\n",
+			__FILE__, __LINE__, nchannel);
+		exit(EXIT_FAILURE);
+	}
+
+	CascadeFilter cascade(fparam, coef);
+	for (unsigned int k = 0; k < cascade.nsection(); ++k)
+	{
+		sections.push_back(cascade.section(k));
+	}
+
+	const unsigned int w = SimdNative::width;
+	nlane = (nchannel + w - 1)/w*w;
+	state1.assign(sections.size()*nlane, 0.0);
+	state2.assign(sections.size()*nlane, 0.0);
+	work.assign(chunk_size*w, 0.0);
+}
+
+/* # 多チャネルストリーミングフィルタ
+ *   1命令で同時に処理するチャネル数
+ */
+unsigned int MultiCascadeFilter::lane_width()
+{
+	return SimdNative::width;
+}
+
+/* # 多チャネルストリーミングフィルタ
+ *   全てのチャネルの状態を0に戻す
+ */
+void MultiCascadeFilter::reset()
+{
+	fill(state1.begin(), state1.end(), 0.0);
+	fill(state2.begin(), state2.end(), 0.0);
+}
+
+/* # 多チャネルストリーミングフィルタ
+ *   インターリーブ形式の信号をその場で処理する
+ *
+ * # 引数
+ * double* data : data[i*nchannel + c]がチャネルcのi点目
+ * size_t nframe : 1チャネルあたりの点数
+ */
+void MultiCascadeFilter::process_interleaved(double* data, const size_t nframe)
+{
+	const unsigned int w = SimdNative::width;
+	for (size_t begin = 0; begin < nframe; begin += chunk_size)
+	{
+		const size_t n = min(nframe - begin, (size_t)chunk_size);
+		double* frame = data + begin*channel;
+
+		unsigned int c = 0;
+		for (; c + w <= channel; c += w)
+		{
+			cascade_lanes<SimdNative>(sections, nlane, &state1[c], &state2[c], frame + c, channel, n);
+		}
+		if (c < channel)
+		{
+			// 端数のチャネルは作業領域に詰めて処理する
+			const unsigned int rest = channel - c;
+			for (size_t i = 0; i < n; ++i)
+			{
+				for (unsigned int l = 0; l < rest; ++l)
+				{
+					work[i*w + l] = frame[i*channel + c + l];
+				}
+			}
+			cascade_lanes<SimdNative>(sections, nlane, &state1[c], &state2[c], work.data(), w, n);
+			for (size_t i = 0; i < n; ++i)
+			{
+				for (unsigned int l = 0; l < rest; ++l)
+				{
+					frame[i*channel + c + l] = work[i*w + l];
+				}
+			}
+		}
+	}
+}
+
+void MultiCascadeFilter::process_interleaved(vector<double>& data)
+{
+	if (data.size() % channel != 0)
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of signal is not a multiple of number of channel.(size : %zu, nchannel : %u)\n",
+			__FILE__, __LINE__, data.size(), channel);
+		exit(EXIT_FAILURE);
+	}
+	process_interleaved(data.data(), data.size()/channel);
+}
+
+/* # 多チャネルストリーミングフィルタ
+ *   プレーナ形式の信号をその場で処理する
+ *   レーン幅ごとのチャネルの組を作業領域へ転置して処理し，書き戻す
+ *
+ * # 引数
+ * double* const* data : data[c][i]がチャネルcのi点目
+ * size_t length : 1チャネルあたりの点数
+ */
+void MultiCascadeFilter::process_planar(double* const* data, const size_t length)
+{
+	const unsigned int w = SimdNative::width;
+	for (size_t begin = 0; begin < length; begin += chunk_size)
+	{
+		const size_t n = min(length - begin, (size_t)chunk_size);
+		for (unsigned int c = 0; c < channel; c += w)
+		{
+			const unsigned int rest = min(w, channel - c);
+			for (unsigned int l = 0; l < rest; ++l)
+			{
+				const double* src = data[c + l] + begin;
+				for (size_t i = 0; i < n; ++i)
+				{
+					work[i*w + l] = src[i];
+				}
+			}
+			cascade_lanes<SimdNative>(sections, nlane, &state1[c], &state2[c], work.data(), w, n);
+			for (unsigned int l = 0; l < rest; ++l)
+			{
+				double* dst = data[c + l] + begin;
+				for (size_t i = 0; i < n; ++i)
+				{
+					dst[i] = work[i*w + l];
+				}
+			}
+		}
+	}
+}
+
+void MultiCascadeFilter::process_planar(vector<vector<double>>& data)
+{
+	if (data.size() != channel)
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Number of channel is illegal.(size : %zu, nchannel : %u)\n",
+			__FILE__, __LINE__, data.size(), channel);
+		exit(EXIT_FAILURE);
+	}
+
+	size_t length = data.empty() ? 0 : data[0].size();
+	vector<double*> ptr(channel);
+	for (unsigned int c = 0; c < channel; ++c)
+	{
+		if (data[c].size() != length)
+		{
+			fprintf(stderr,
+				"Error: [%s l.%d]Length of channel is not equal.(channel %u : %zu, channel 0 : %zu)\n",
+				__FILE__, __LINE__, c, data[c].size(), length);
+			exit(EXIT_FAILURE);
+		}
+		ptr[c] = data[c].data();
+	}
+	process_planar(ptr.data(), length);
+}
+
+constexpr unsigned int LiveCascadeFilter::chunk_size;
+constexpr unsigned int LiveCascadeFilter::fresh_flag;
+
+/* # 差し替え可能なストリーミングフィルタ
+ *   コンストラクタ
+ *
+ * # 引数
+ * FilterParam& fparam : 係数列の次数を与えるフィルタパラメータ
+ * vector<double> coef : 初期の係数列(a0, a1, a2[0], a2[1],..., b1, b2[0], b2[1],...)
+ * unsigned int crossfade : 係数を差し替えるときのクロスフェードの点数(0なら即座に切り替える)
+ */
+LiveCascadeFilter::LiveCascadeFilter
+(const FilterParam& fparam, const vector<double>& coef, const unsigned int crossfade)
+:fparam(fparam), fade_length(crossfade), back(0), middle(1), front(2),
+ fade_buffer(chunk_size, 0.0), fade_remain(0), swap_count(0)
+{
+	CascadeFilter cascade(fparam, coef);
+	for (unsigned int k = 0; k < cascade.nsection(); ++k)
+	{
+		active.push_back(cascade.section(k));
+	}
+	for (auto& sl : slot)
+	{
+		sl = active;
+	}
+	fading = active;
+}
+
+/* # 差し替え可能なストリーミングフィルタ
+ *   新しい係数を送信する(送信側のスレッドから呼ぶ)
+ *   書き込み枠に係数を書き込み，受け渡し枠と交換する
+ *   処理側が読み込む前に再び送信した場合は，古い方の係数を捨てる
+ *
+ * # 引数
+ * vector<double> coef : 係数列(a0, a1, a2[0], a2[1],..., b1, b2[0], b2[1],...)
+ */
+void LiveCascadeFilter::publish(const vector<double>& coef)
+{
+	CascadeFilter cascade(fparam, coef);
+	for (unsigned int k = 0; k < cascade.nsection(); ++k)
+	{
+		slot[back][k] = cascade.section(k);
+	}
+	back = middle.exchange(back | fresh_flag, memory_order_acq_rel) & ~fresh_flag;
+}
+
+/* # 差し替え可能なストリーミングフィルタ
+ *   受け渡し枠に未読の係数があれば読み出し枠と交換し，節の状態を保ったまま係数を入れ替える
+ */
+void LiveCascadeFilter::acquire()
+{
+	if ((middle.load(memory_order_relaxed) & fresh_flag) == 0)
+	{
+		return;
+	}
+	front = middle.exchange(front, memory_order_acq_rel) & ~fresh_flag;
+
+	if (fade_length > 0)
+	{
+		fading = active;
+		fade_remain = fade_length;
+	}
+	const vector<BiquadSection>& next = slot[front];
+	for (unsigned int k = 0; k < active.size(); ++k)
+	{
+		active[k].b0 = next[k].b0;
+		active[k].b1 = next[k].b1;
+		active[k].b2 = next[k].b2;
+		active[k].a1 = next[k].a1;
+		active[k].a2 = next[k].a2;
+	}
+	++swap_count;
+}
+
+/* # 差し替え可能なストリーミングフィルタ
+ *   全ての節の状態を0に戻し，クロスフェードを打ち切る(処理側のスレッドから呼ぶ)
+ */
+void LiveCascadeFilter::reset()
+{
+	for (auto& sec : active)
+	{
+		sec.s1 = 0.0;
+		sec.s2 = 0.0;
+	}
+	fade_remain = 0;
+}
+
+/* # 差し替え可能なストリーミングフィルタ
+ *   長さlengthの信号dataをその場で処理する(処理側のスレッドから呼ぶ)
+ *   ブロックの先頭で新しい係数を確認してから，chunk_size点の区間ごとに全ての節を適用する
+ */
+void LiveCascadeFilter::process(double* data, const size_t length)
+{
+	if (fade_remain == 0)
+	{
+		acquire();
+	}
+
+	for (size_t begin = 0; begin < length; begin += chunk_size)
+	{
+		double* x = data + begin;
+		const size_t n = min(length - begin, (size_t)chunk_size);
+		if (fade_remain == 0)
+		{
+			cascade_sections(active, x, n);
+			continue;
+		}
+
+		// 古い係数と新しい係数の両方で処理し，出力を線形に混ぜる
+		const size_t nfade = min(n, (size_t)fade_remain);
+		copy(x, x + nfade, fade_buffer.begin());
+		cascade_sections(fading, fade_buffer.data(), nfade);
+		cascade_sections(active, x, n);
+
+		const double step = 1.0/fade_length;
+		double gain = (fade_length - fade_remain + 1)*step;
+		for (size_t i = 0; i < nfade; ++i, gain += step)
+		{
+			x[i] = fade_buffer[i] + gain*(x[i] - fade_buffer[i]);
+		}
+		fade_remain -= nfade;
+	}
+}
+
+void LiveCascadeFilter::process(vector<double>& data)
+{
+	process(data.data(), data.size());
+}
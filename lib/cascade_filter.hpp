@@ -0,0 +1,184 @@
+/*
+ * cascade_filter.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ *
+ * This cord is written by UTF-8
+ */
+
+#ifndef CASCADE_FILTER_HPP_
+#define CASCADE_FILTER_HPP_
+
+#include "filter_param.hpp"
+
+#include <atomic>
+
+/* 2次の節(biquad)の係数と状態
+ *   H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2)
+ *   転置型直接II型で s1, s2 を状態に持つ
+ *     y = b0 x + s1
+ *     s1 = b1 x - a1 y + s2
+ *     s2 = b2 x - a2 y
+ */
+struct BiquadSection
+{
+	double b0, b1, b2;
+	double a1, a2;
+	double s1, s2;
+
+	BiquadSection()
+	: b0(1.0), b1(0.0), b2(0.0), a1(0.0), a2(0.0), s1(0.0), s2(0.0)
+	{}
+};
+
+/* 設計した縦続型IIRフィルタを信号に適用するストリーミングフィルタ
+ *   係数列(a0, a1, a2[0], a2[1],..., b1, b2[0], b2[1],...)の分子の節と分母の節を
+ *   先頭から順に組にして2次の節(biquad)の縦続接続とする
+ *   奇数次の1次の節は(1 + c z^-1)としてfreq_resと同じく先頭の節に置き，
+ *   節の数が分子と分母で異なる場合は残りの節の相手を1とする
+ *   利得a0は先頭の節の分子に掛ける
+ *
+ *   processはブロックをchunk_size点ずつに区切り，各区間で2節ずつ全点を処理する
+ *   区間がL1キャッシュに収まるため，長い信号でも節の数だけ主記憶を往復しない
+ *   ブロックの境界をまたいで状態を保持するため，信号を任意の長さに分けて渡してよい
+ *
+ *   process_parallelは長い信号をブロックに分けて複数コアで処理し，
+ *   ブロック境界の状態を零入力応答の重ね合わせで後から補正する(オフライン処理用)
+ */
+class CascadeFilter
+{
+private:
+	static constexpr unsigned int chunk_size = 512;	// 節ごとに処理する区間の点数
+	static constexpr size_t parallel_block_min = 1u << 16;	// process_parallelの1ブロックの最小点数
+	static constexpr double parallel_tail_eps = 1e-20;		// 零入力応答を打ち切る状態の大きさ
+
+	vector<BiquadSection> sections;
+
+public:
+	CascadeFilter(const FilterParam&, const vector<double>&);
+
+	// get function
+
+	unsigned int nsection() const
+	{ return sections.size(); }
+	const BiquadSection& section(const unsigned int k) const
+	{ return sections.at(k); }
+
+	// normal function
+
+	void reset();
+	double process(const double);
+	void process(double*, const size_t);
+	void process(vector<double>&);
+	void process_parallel(double*, const size_t, ThreadPool& pool = ThreadPool::global());
+	void process_parallel(vector<double>&, ThreadPool& pool = ThreadPool::global());
+};
+
+/* 同じ係数の縦続型IIRフィルタを複数チャネルにまとめて適用するストリーミングフィルタ
+ *   チャネルをSIMDレジスタのレーンに並べ，lane_width()個(AVX2で4，AVX-512で8)の
+ *   チャネルを1命令で進める
+ *   節の構成はCascadeFilterと同じで，状態はチャネルごとに独立に保持する
+ *
+ *   インターリーブ形式 : data[i*nchannel + c] がチャネルcのi点目
+ *   プレーナ形式       : data[c][i] がチャネルcのi点目
+ *   インターリーブ形式ではレーン幅の倍数のチャネルをその場で読み書きし，
+ *   端数のチャネルとプレーナ形式は作業領域へ転置してから処理する
+ */
+class MultiCascadeFilter
+{
+private:
+	static constexpr unsigned int chunk_size = 256;	// 節ごとに処理する区間の点数
+
+	vector<BiquadSection> sections;		// 係数(状態は使わない)
+	unsigned int channel;
+	unsigned int nlane;					// チャネル数をレーン幅の倍数に切り上げた値
+	aligned_vector<double> state1;		// 節kのチャネルcの状態 : state1[k*nlane + c]
+	aligned_vector<double> state2;
+	aligned_vector<double> work;		// 転置用の作業領域(chunk_size点 × レーン幅)
+
+public:
+	MultiCascadeFilter(const FilterParam&, const vector<double>&, const unsigned int);
+
+	// get function
+
+	unsigned int nchannel() const
+	{ return channel; }
+	unsigned int nsection() const
+	{ return sections.size(); }
+	static unsigned int lane_width();
+
+	// normal function
+
+	void reset();
+	void process_interleaved(double*, const size_t);
+	void process_interleaved(vector<double>&);
+	void process_planar(double* const*, const size_t);
+	void process_planar(vector<vector<double>>&);
+};
+
+/* 係数を停止せずに差し替えられるストリーミングフィルタ
+ *   最適化で得た新しい係数を，処理中のスレッドを止めずに読み込ませる
+ *   送信側(publish)と処理側(process)はそれぞれ1スレッドずつとし，
+ *   係数の受け渡しには3つの枠を使う(送信側の書き込み枠，受け渡し枠，処理側の読み出し枠)
+ *   どちらの側も枠の番号を1回のatomicな交換で受け渡すため，待ちもロックも発生しない
+ *   (2枠では処理側が読み出し中の枠を送信側が上書きしうるため3枠とする)
+ *
+ *   処理側は各ブロックの先頭で新しい係数の有無を確認し，あれば節の状態を保ったまま係数を入れ替える
+ *   crossfade > 0 の場合は古い係数のフィルタも並行して動かし，
+ *   crossfade点かけて出力を古い係数から新しい係数へ線形に移す
+ *   クロスフェード中に届いた係数は，クロスフェードの完了後のブロックで読み込む
+ *
+ *   作業領域は全て構築時に確保し，processの中では確保もロックも行わない
+ *   publishはFilterParamを参照して係数を変換するため，FilterParamを先に破棄しないこと
+ */
+class LiveCascadeFilter
+{
+private:
+	static constexpr unsigned int chunk_size = 512;	// 節ごとに処理する区間の点数
+	static constexpr unsigned int fresh_flag = 4;	// 受け渡し枠に未読の係数があることを示すビット
+
+	const FilterParam& fparam;
+	unsigned int fade_length;
+
+	// 3つの係数の枠(状態は使わない)
+	vector<BiquadSection> slot[3];
+	unsigned int back;					// 送信側の書き込み枠(送信側のみが触る)
+	atomic<unsigned int> middle;		// 受け渡し枠の番号 | fresh_flag
+	unsigned int front;					// 処理側の読み出し枠(処理側のみが触る)
+
+	// 処理側の作業領域
+	vector<BiquadSection> active;		// 現在の係数と状態
+	vector<BiquadSection> fading;		// クロスフェード中の古い係数と状態
+	vector<double> fade_buffer;			// 古い係数による出力(chunk_size点)
+	unsigned int fade_remain;			// クロスフェードの残り点数
+	unsigned long swap_count;
+
+	void acquire();
+
+public:
+	LiveCascadeFilter(const FilterParam&, const vector<double>&, const unsigned int crossfade = 0);
+
+	LiveCascadeFilter(const LiveCascadeFilter&) = delete;
+	LiveCascadeFilter& operator=(const LiveCascadeFilter&) = delete;
+
+	// get function
+
+	unsigned int nsection() const
+	{ return active.size(); }
+	unsigned int crossfade_length() const
+	{ return fade_length; }
+	bool is_crossfading() const
+	{ return fade_remain > 0; }
+	unsigned long nswap() const
+	{ return swap_count; }
+
+	// normal function
+
+	void publish(const vector<double>&);
+	void reset();
+	void process(double*, const size_t);
+	void process(vector<double>&);
+};
+
+#endif /* CASCADE_FILTER_HPP_ */
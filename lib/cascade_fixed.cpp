@@ -0,0 +1,106 @@
+/*
+ * cascade_fixed.cpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ *
+ * This cord is written by UTF-8
+ */
+
+#include "cascade_kernel.hpp"
+
+using namespace std;
+
+/* # 次数固定カーネルの一覧の要素
+ *   CASCADE_FIXED_ORDER_LISTの次数の組ごとに1つ生成する
+ */
+struct FixedKernelEntry
+{
+	unsigned int n_order;
+	unsigned int m_order;
+	CascadeKernels kernels;
+};
+
+#define CASCADE_FIXED_ORDER_ENTRY(N, M) { N, M, cascade_kernels<FixedOrder<N, M>>() },
+
+#ifdef CASCADE_FIXED_ORDER_MAX
+
+constexpr unsigned int fixed_order_size = CASCADE_FIXED_ORDER_MAX + 1;
+typedef CascadeKernels FixedKernelTable[fixed_order_size][fixed_order_size];
+
+/* # 次数固定カーネルの表の生成
+ *   分母次数Mについて再帰し，table[N][0 : M]を埋める
+ */
+template <unsigned int N, unsigned int M>
+struct FixedKernelRow
+{
+	static void fill(FixedKernelTable& table)
+	{
+		table[N][M] = cascade_kernels<FixedOrder<N, M>>();
+		FixedKernelRow<N, M - 1>::fill(table);
+	}
+};
+
+template <unsigned int N>
+struct FixedKernelRow<N, 0>
+{
+	static void fill(FixedKernelTable& table)
+	{
+		table[N][0] = cascade_kernels<FixedOrder<N, 0>>();
+	}
+};
+
+/* # 次数固定カーネルの表の生成
+ *   分子次数Nについて再帰し，table[0 : N][0 : CASCADE_FIXED_ORDER_MAX]を埋める
+ */
+template <unsigned int N>
+struct FixedKernelColumn
+{
+	static void fill(FixedKernelTable& table)
+	{
+		FixedKernelRow<N, CASCADE_FIXED_ORDER_MAX>::fill(table);
+		FixedKernelColumn<N - 1>::fill(table);
+	}
+};
+
+template <>
+struct FixedKernelColumn<0>
+{
+	static void fill(FixedKernelTable& table)
+	{
+		FixedKernelRow<0, CASCADE_FIXED_ORDER_MAX>::fill(table);
+	}
+};
+
+struct FixedKernelRegistry
+{
+	FixedKernelTable table;
+
+	FixedKernelRegistry()
+	{ FixedKernelColumn<CASCADE_FIXED_ORDER_MAX>::fill(table); }
+};
+
+#endif
+
+bool fixed_cascade_kernels(const unsigned int n_order, const unsigned int m_order, CascadeKernels& kernels)
+{
+#ifdef CASCADE_FIXED_ORDER_MAX
+	if (n_order <= CASCADE_FIXED_ORDER_MAX && m_order <= CASCADE_FIXED_ORDER_MAX)
+	{
+		static const FixedKernelRegistry registry;
+		kernels = registry.table[n_order][m_order];
+		return true;
+	}
+#endif
+
+	static const FixedKernelEntry entries[] = { CASCADE_FIXED_ORDER_LIST(CASCADE_FIXED_ORDER_ENTRY) };
+	for (auto& entry : entries)
+	{
+		if (entry.n_order == n_order && entry.m_order == m_order)
+		{
+			kernels = entry.kernels;
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,1536 @@
+/*
+ * cascade_kernel.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ *
+ * This cord is written by UTF-8
+ */
+
+#ifndef CASCADE_KERNEL_HPP_
+#define CASCADE_KERNEL_HPP_
+
+#include "filter_param.hpp"
+#include "simd.hpp"
+
+#include <limits>
+
+// 次数を固定したカーネル(FixedOrder)を生成する(分子次数, 分母次数)の組
+// desire_filter.csvの設計例と，奇数次の節を含む代表的な次数
+#ifndef CASCADE_FIXED_ORDER_LIST
+#define CASCADE_FIXED_ORDER_LIST(X) \
+	X(2, 8) X(4, 6) X(6, 4) X(8, 2) X(12, 8) X(16, 14) \
+	X(5, 5) X(7, 4) X(8, 3) X(9, 6)
+#endif
+
+// CASCADE_FIXED_ORDER_MAXを定義すると，0からその次数までの全ての組のカーネルも生成する
+// (20で441通りとなり，コンパイルに数分かかる)
+
+/* # 縦続型IIRフィルタの2次の節の乗算
+ *   (pr + j pi) *= 1 + c1 e^-jω + c2 e^-j2ω
+ *   mul_section_regは係数をレジスタで受け取る(候補解方向のSIMD化で使用)
+ */
+template <typename V>
+SIMD_INLINE void mul_section_reg
+(const typename V::reg& v1, const typename V::reg& v2,
+	const typename V::reg& z1r, const typename V::reg& z1i,
+	const typename V::reg& z2r, const typename V::reg& z2i,
+	typename V::reg& pr, typename V::reg& pi)
+{
+	typedef typename V::reg reg;
+
+	const reg sr = V::fmadd(v2, z2r, V::fmadd(v1, z1r, V::set1(1.0)));
+	const reg si = V::fmadd(v2, z2i, V::mul(v1, z1i));
+	const reg tr = V::fnmadd(pi, si, V::mul(pr, sr));
+	pi = V::fmadd(pi, sr, V::mul(pr, si));
+	pr = tr;
+}
+
+template <typename V>
+SIMD_INLINE void mul_section
+(const double c1, const double c2,
+	const typename V::reg& z1r, const typename V::reg& z1i,
+	const typename V::reg& z2r, const typename V::reg& z2i,
+	typename V::reg& pr, typename V::reg& pi)
+{
+	mul_section_reg<V>(V::set1(c1), V::set1(c2), z1r, z1i, z2r, z2i, pr, pi);
+}
+
+/* # 縦続型IIRフィルタの1次の節
+ *   (pr + j pi) = 1 + c1 e^-jω
+ *   first_section_regは係数をレジスタで受け取る
+ */
+template <typename V>
+SIMD_INLINE void first_section_reg
+(const typename V::reg& v1, const typename V::reg& z1r, const typename V::reg& z1i,
+	typename V::reg& pr, typename V::reg& pi)
+{
+	pr = V::fmadd(v1, z1r, V::set1(1.0));
+	pi = V::mul(v1, z1i);
+}
+
+template <typename V>
+SIMD_INLINE void first_section
+(const double c1, const typename V::reg& z1r, const typename V::reg& z1i,
+	typename V::reg& pr, typename V::reg& pi)
+{
+	first_section_reg<V>(V::set1(c1), z1r, z1i, pr, pi);
+}
+
+/* # 縦続型IIRフィルタの2次の節の乗算(群遅延用の微分を同時に更新)
+ *   節 S = 1 + c1 e^-jω + c2 e^-j2ω と P = c1 e^-jω + 2 c2 e^-j2ω について
+ *     (qr + j qi) = (q * S) + (p * P)
+ *     (pr + j pi) *= S
+ *   Sは周波数特性と群遅延で共有する
+ */
+template <typename V>
+SIMD_INLINE void mul_section_gd
+(const double c1, const double c2,
+	const typename V::reg& z1r, const typename V::reg& z1i,
+	const typename V::reg& z2r, const typename V::reg& z2i,
+	typename V::reg& pr, typename V::reg& pi, typename V::reg& qr, typename V::reg& qi)
+{
+	typedef typename V::reg reg;
+
+	const reg v1 = V::set1(c1);
+	const reg v2 = V::set1(c2);
+	const reg w2 = V::set1(2.0*c2);
+	const reg ur = V::fmadd(v1, z1r, V::mul(w2, z2r));
+	const reg ui = V::fmadd(v1, z1i, V::mul(w2, z2i));
+	const reg sr = V::fmadd(v2, z2r, V::fmadd(v1, z1r, V::set1(1.0)));
+	const reg si = V::fmadd(v2, z2i, V::mul(v1, z1i));
+
+	const reg tqr = V::fnmadd(pi, ui, V::fmadd(pr, ur, V::fnmadd(qi, si, V::mul(qr, sr))));
+	qi = V::fmadd(pi, ur, V::fmadd(pr, ui, V::fmadd(qi, sr, V::mul(qr, si))));
+	qr = tqr;
+
+	const reg tr = V::fnmadd(pi, si, V::mul(pr, sr));
+	pi = V::fmadd(pi, sr, V::mul(pr, si));
+	pr = tr;
+}
+
+/* # 縦続型IIRフィルタの1次の節(群遅延用の微分を同時に設定)
+ *   (pr + j pi) = 1 + c1 e^-jω
+ *   (qr + j qi) = c1 e^-jω
+ */
+template <typename V>
+SIMD_INLINE void first_section_gd
+(const double c1, const typename V::reg& z1r, const typename V::reg& z1i,
+	typename V::reg& pr, typename V::reg& pi, typename V::reg& qr, typename V::reg& qi)
+{
+	const typename V::reg v1 = V::set1(c1);
+	qr = V::mul(v1, z1r);
+	qi = V::mul(v1, z1i);
+	pr = V::add(qr, V::set1(1.0));
+	pi = qi;
+}
+
+/* # 縦続型IIRフィルタの群遅延の仕上げ
+ *   総乗Πと微分Qから Re{Q_N / N} - Re{Q_D / D}
+ *   |D|^2はdivide_resと共有するため引数で受け取る
+ */
+template <typename V>
+SIMD_INLINE typename V::reg divide_gd
+(const typename V::reg& nr, const typename V::reg& ni,
+	const typename V::reg& qnr, const typename V::reg& qni,
+	const typename V::reg& dr, const typename V::reg& di,
+	const typename V::reg& qdr, const typename V::reg& qdi,
+	const typename V::reg& dnorm)
+{
+	const typename V::reg nnorm = V::fmadd(nr, nr, V::mul(ni, ni));
+	return V::sub(
+		V::div(V::fmadd(qnr, nr, V::mul(qni, ni)), nnorm),
+		V::div(V::fmadd(qdr, dr, V::mul(qdi, di)), dnorm));
+}
+
+/* # 縦続型IIRフィルタの2次の節の振幅2乗の乗算
+ *   p *= |1 + c1 e^-jω + c2 e^-j2ω|^2 = (1 + c1^2 + c2^2) + 2 c1 (1 + c2) cosω + 2 c2 cos2ω
+ *   実数の多項式のため，複素数の乗算を行わない
+ */
+template <typename V>
+SIMD_INLINE void power_section
+(const double c1, const double c2,
+	const typename V::reg& cw, const typename V::reg& c2w, typename V::reg& p)
+{
+	const typename V::reg s = V::fmadd(V::set1(2.0*c2), c2w,
+		V::fmadd(V::set1(2.0*c1*(1.0 + c2)), cw, V::set1(1.0 + c1*c1 + c2*c2)));
+	p = V::mul(p, s);
+}
+
+/* # 縦続型IIRフィルタの1次の節の振幅2乗
+ *   p = |1 + c1 e^-jω|^2 = (1 + c1^2) + 2 c1 cosω
+ */
+template <typename V>
+SIMD_INLINE void first_power_section
+(const double c1, const typename V::reg& cw, typename V::reg& p)
+{
+	p = V::fmadd(V::set1(2.0*c1), cw, V::set1(1.0 + c1*c1));
+}
+
+/* # 縦続型IIRフィルタの周波数特性の仕上げ
+ *   H = a0 * N / D = a0 * N * conj(D) / |D|^2
+ *   divide_res_regは利得a0をレジスタで受け取る
+ */
+template <typename V>
+SIMD_INLINE void divide_res_reg
+(const typename V::reg& a0,
+	const typename V::reg& nr, const typename V::reg& ni,
+	const typename V::reg& dr, const typename V::reg& di,
+	typename V::reg& re, typename V::reg& im)
+{
+	typedef typename V::reg reg;
+
+	const reg scale = V::div(a0, V::fmadd(dr, dr, V::mul(di, di)));
+	re = V::mul(V::fmadd(nr, dr, V::mul(ni, di)), scale);
+	im = V::mul(V::fnmadd(nr, di, V::mul(ni, dr)), scale);
+}
+
+template <typename V>
+SIMD_INLINE void divide_res
+(const double a0,
+	const typename V::reg& nr, const typename V::reg& ni,
+	const typename V::reg& dr, const typename V::reg& di,
+	typename V::reg& re, typename V::reg& im)
+{
+	divide_res_reg<V>(V::set1(a0), nr, ni, dr, di, re, im);
+}
+
+/* # 縦続型IIRフィルタの周波数特性と群遅延の仕上げ
+ *   |D|^2を一度だけ計算して両方に使う
+ */
+template <typename V>
+SIMD_INLINE void divide_res_gd
+(const double a0,
+	const typename V::reg& nr, const typename V::reg& ni,
+	const typename V::reg& qnr, const typename V::reg& qni,
+	const typename V::reg& dr, const typename V::reg& di,
+	const typename V::reg& qdr, const typename V::reg& qdi,
+	typename V::reg& re, typename V::reg& im, typename V::reg& gd)
+{
+	typedef typename V::reg reg;
+
+	const reg dnorm = V::fmadd(dr, dr, V::mul(di, di));
+	const reg scale = V::div(V::set1(a0), dnorm);
+	re = V::mul(V::fmadd(nr, dr, V::mul(ni, di)), scale);
+	im = V::mul(V::fnmadd(nr, di, V::mul(ni, dr)), scale);
+	gd = divide_gd<V>(nr, ni, qnr, qni, dr, di, qdr, qdi, dnorm);
+}
+
+/* # 縦続型IIRフィルタの2次の節の総乗(節数Kをコンパイル時に固定)
+ *   テンプレートの再帰により節のループを完全に展開する
+ */
+template <typename V, unsigned int K>
+struct SectionProduct
+{
+	static SIMD_INLINE void apply
+	(const double* c,
+		const typename V::reg& z1r, const typename V::reg& z1i,
+		const typename V::reg& z2r, const typename V::reg& z2i,
+		typename V::reg& pr, typename V::reg& pi)
+	{
+		mul_section<V>(c[0], c[1], z1r, z1i, z2r, z2i, pr, pi);
+		SectionProduct<V, K - 1>::apply(c + 2, z1r, z1i, z2r, z2i, pr, pi);
+	}
+};
+
+template <typename V>
+struct SectionProduct<V, 0>
+{
+	static SIMD_INLINE void apply
+	(const double*,
+		const typename V::reg&, const typename V::reg&,
+		const typename V::reg&, const typename V::reg&,
+		typename V::reg&, typename V::reg&)
+	{}
+};
+
+/* # 縦続型IIRフィルタの2次の節の振幅2乗の総乗(節数Kをコンパイル時に固定)
+ */
+template <typename V, unsigned int K>
+struct SectionPower
+{
+	static SIMD_INLINE void apply
+	(const double* c, const typename V::reg& cw, const typename V::reg& c2w, typename V::reg& p)
+	{
+		power_section<V>(c[0], c[1], cw, c2w, p);
+		SectionPower<V, K - 1>::apply(c + 2, cw, c2w, p);
+	}
+};
+
+template <typename V>
+struct SectionPower<V, 0>
+{
+	static SIMD_INLINE void apply
+	(const double*, const typename V::reg&, const typename V::reg&, typename V::reg&)
+	{}
+};
+
+/* # 縦続型IIRフィルタの2次の節の総乗と微分(節数Kをコンパイル時に固定)
+ */
+template <typename V, unsigned int K>
+struct SectionProductGd
+{
+	static SIMD_INLINE void apply
+	(const double* c,
+		const typename V::reg& z1r, const typename V::reg& z1i,
+		const typename V::reg& z2r, const typename V::reg& z2i,
+		typename V::reg& pr, typename V::reg& pi, typename V::reg& qr, typename V::reg& qi)
+	{
+		mul_section_gd<V>(c[0], c[1], z1r, z1i, z2r, z2i, pr, pi, qr, qi);
+		SectionProductGd<V, K - 1>::apply(c + 2, z1r, z1i, z2r, z2i, pr, pi, qr, qi);
+	}
+};
+
+template <typename V>
+struct SectionProductGd<V, 0>
+{
+	static SIMD_INLINE void apply
+	(const double*,
+		const typename V::reg&, const typename V::reg&,
+		const typename V::reg&, const typename V::reg&,
+		typename V::reg&, typename V::reg&, typename V::reg&, typename V::reg&)
+	{}
+};
+
+/* # 次数を実行時に与えるカーネルの方針
+ *   OddN, OddMは分子・分母次数が奇数のとき，先頭に1次の節を持つことを示す
+ *   (CascadeType::SE : <false, false>, CascadeType::SO : <true, true>,
+ *    CascadeType::NO : <true, false>, CascadeType::MO : <false, true>)
+ */
+template <bool OddN, bool OddM>
+struct DynamicOrder
+{
+	static constexpr bool odd_n = OddN;
+	static constexpr bool odd_m = OddM;
+
+	static unsigned int zero_order(const unsigned int n_order)
+	{ return n_order; }
+	static unsigned int pole_order(const unsigned int m_order)
+	{ return m_order; }
+
+	template <typename V>
+	static SIMD_INLINE void block
+	(const double* coef, const unsigned int n_order, const unsigned int m_order,
+		const double* c1r, const double* c1i, const double* c2r, const double* c2i,
+		typename V::reg& re, typename V::reg& im)
+	{
+		typedef typename V::reg reg;
+
+		const reg z1r = V::load(c1r);
+		const reg z1i = V::load(c1i);
+		const reg z2r = V::load(c2r);
+		const reg z2i = V::load(c2i);
+
+		// 分子の総乗
+		reg nr = V::set1(1.0);
+		reg ni = V::zero();
+		unsigned int n = 1;
+		if (OddN)
+		{
+			first_section<V>(coef[1], z1r, z1i, nr, ni);
+			n = 2;
+		}
+		for (; n < n_order; n += 2)
+		{
+			mul_section<V>(coef[n], coef[n + 1], z1r, z1i, z2r, z2i, nr, ni);
+		}
+
+		// 分母の総乗
+		const unsigned int opt_order = 1 + n_order + m_order;
+		reg dr = V::set1(1.0);
+		reg di = V::zero();
+		unsigned int m = n_order + 1;
+		if (OddM)
+		{
+			first_section<V>(coef[n_order + 1], z1r, z1i, dr, di);
+			m = n_order + 2;
+		}
+		for (; m < opt_order; m += 2)
+		{
+			mul_section<V>(coef[m], coef[m + 1], z1r, z1i, z2r, z2i, dr, di);
+		}
+
+		divide_res<V>(coef[0], nr, ni, dr, di, re, im);
+	}
+
+	// 周波数特性と群遅延を同じ節の走査で計算する
+	template <typename V>
+	static SIMD_INLINE void block_gd
+	(const double* coef, const unsigned int n_order, const unsigned int m_order,
+		const double* c1r, const double* c1i, const double* c2r, const double* c2i,
+		typename V::reg& re, typename V::reg& im, typename V::reg& gd)
+	{
+		typedef typename V::reg reg;
+
+		const reg z1r = V::load(c1r);
+		const reg z1i = V::load(c1i);
+		const reg z2r = V::load(c2r);
+		const reg z2i = V::load(c2i);
+
+		reg nr = V::set1(1.0);
+		reg ni = V::zero();
+		reg qnr = V::zero();
+		reg qni = V::zero();
+		unsigned int n = 1;
+		if (OddN)
+		{
+			first_section_gd<V>(coef[1], z1r, z1i, nr, ni, qnr, qni);
+			n = 2;
+		}
+		for (; n < n_order; n += 2)
+		{
+			mul_section_gd<V>(coef[n], coef[n + 1], z1r, z1i, z2r, z2i, nr, ni, qnr, qni);
+		}
+
+		const unsigned int opt_order = 1 + n_order + m_order;
+		reg dr = V::set1(1.0);
+		reg di = V::zero();
+		reg qdr = V::zero();
+		reg qdi = V::zero();
+		unsigned int m = n_order + 1;
+		if (OddM)
+		{
+			first_section_gd<V>(coef[n_order + 1], z1r, z1i, dr, di, qdr, qdi);
+			m = n_order + 2;
+		}
+		for (; m < opt_order; m += 2)
+		{
+			mul_section_gd<V>(coef[m], coef[m + 1], z1r, z1i, z2r, z2i, dr, di, qdr, qdi);
+		}
+
+		divide_res_gd<V>(coef[0], nr, ni, qnr, qni, dr, di, qdr, qdi, re, im, gd);
+	}
+
+	// 振幅2乗特性|H|^2をcosω, cos2ωの実数演算のみで計算する
+	template <typename V>
+	static SIMD_INLINE void block_power
+	(const double* coef, const unsigned int n_order, const unsigned int m_order,
+		const double* cwp, const double* c2wp, typename V::reg& power)
+	{
+		typedef typename V::reg reg;
+
+		const reg cw = V::load(cwp);
+		const reg c2w = V::load(c2wp);
+
+		reg pn = V::set1(1.0);
+		unsigned int n = 1;
+		if (OddN)
+		{
+			first_power_section<V>(coef[1], cw, pn);
+			n = 2;
+		}
+		for (; n < n_order; n += 2)
+		{
+			power_section<V>(coef[n], coef[n + 1], cw, c2w, pn);
+		}
+
+		const unsigned int opt_order = 1 + n_order + m_order;
+		reg pd = V::set1(1.0);
+		unsigned int m = n_order + 1;
+		if (OddM)
+		{
+			first_power_section<V>(coef[n_order + 1], cw, pd);
+			m = n_order + 2;
+		}
+		for (; m < opt_order; m += 2)
+		{
+			power_section<V>(coef[m], coef[m + 1], cw, c2w, pd);
+		}
+
+		power = V::div(V::mul(V::set1(coef[0]*coef[0]), pn), pd);
+	}
+};
+
+/* # 次数をコンパイル時に固定したカーネルの方針
+ *   節のループの回数が定数になり，SectionProductで完全に展開される
+ *   引数のn_order, m_orderは使わない
+ */
+template <unsigned int N, unsigned int M>
+struct FixedOrder
+{
+	static constexpr bool odd_n = (N % 2) == 1;
+	static constexpr bool odd_m = (M % 2) == 1;
+
+	static constexpr unsigned int zero_order(const unsigned int)
+	{ return N; }
+	static constexpr unsigned int pole_order(const unsigned int)
+	{ return M; }
+
+	template <typename V>
+	static SIMD_INLINE void block
+	(const double* coef, const unsigned int, const unsigned int,
+		const double* c1r, const double* c1i, const double* c2r, const double* c2i,
+		typename V::reg& re, typename V::reg& im)
+	{
+		typedef typename V::reg reg;
+
+		const reg z1r = V::load(c1r);
+		const reg z1i = V::load(c1i);
+		const reg z2r = V::load(c2r);
+		const reg z2i = V::load(c2i);
+
+		reg nr = V::set1(1.0);
+		reg ni = V::zero();
+		if (odd_n)
+		{
+			first_section<V>(coef[1], z1r, z1i, nr, ni);
+		}
+		SectionProduct<V, N/2>::apply(coef + 1 + N%2, z1r, z1i, z2r, z2i, nr, ni);
+
+		reg dr = V::set1(1.0);
+		reg di = V::zero();
+		if (odd_m)
+		{
+			first_section<V>(coef[N + 1], z1r, z1i, dr, di);
+		}
+		SectionProduct<V, M/2>::apply(coef + N + 1 + M%2, z1r, z1i, z2r, z2i, dr, di);
+
+		divide_res<V>(coef[0], nr, ni, dr, di, re, im);
+	}
+
+	template <typename V>
+	static SIMD_INLINE void block_gd
+	(const double* coef, const unsigned int, const unsigned int,
+		const double* c1r, const double* c1i, const double* c2r, const double* c2i,
+		typename V::reg& re, typename V::reg& im, typename V::reg& gd)
+	{
+		typedef typename V::reg reg;
+
+		const reg z1r = V::load(c1r);
+		const reg z1i = V::load(c1i);
+		const reg z2r = V::load(c2r);
+		const reg z2i = V::load(c2i);
+
+		reg nr = V::set1(1.0);
+		reg ni = V::zero();
+		reg qnr = V::zero();
+		reg qni = V::zero();
+		if (odd_n)
+		{
+			first_section_gd<V>(coef[1], z1r, z1i, nr, ni, qnr, qni);
+		}
+		SectionProductGd<V, N/2>::apply(coef + 1 + N%2, z1r, z1i, z2r, z2i, nr, ni, qnr, qni);
+
+		reg dr = V::set1(1.0);
+		reg di = V::zero();
+		reg qdr = V::zero();
+		reg qdi = V::zero();
+		if (odd_m)
+		{
+			first_section_gd<V>(coef[N + 1], z1r, z1i, dr, di, qdr, qdi);
+		}
+		SectionProductGd<V, M/2>::apply(coef + N + 1 + M%2, z1r, z1i, z2r, z2i, dr, di, qdr, qdi);
+
+		divide_res_gd<V>(coef[0], nr, ni, qnr, qni, dr, di, qdr, qdi, re, im, gd);
+	}
+
+	template <typename V>
+	static SIMD_INLINE void block_power
+	(const double* coef, const unsigned int, const unsigned int,
+		const double* cwp, const double* c2wp, typename V::reg& power)
+	{
+		typedef typename V::reg reg;
+
+		const reg cw = V::load(cwp);
+		const reg c2w = V::load(c2wp);
+
+		reg pn = V::set1(1.0);
+		if (odd_n)
+		{
+			first_power_section<V>(coef[1], cw, pn);
+		}
+		SectionPower<V, N/2>::apply(coef + 1 + N%2, cw, c2w, pn);
+
+		reg pd = V::set1(1.0);
+		if (odd_m)
+		{
+			first_power_section<V>(coef[N + 1], cw, pd);
+		}
+		SectionPower<V, M/2>::apply(coef + N + 1 + M%2, cw, c2w, pd);
+
+		power = V::div(V::mul(V::set1(coef[0]*coef[0]), pn), pd);
+	}
+};
+
+/* # 縦続型IIRフィルタの周波数特性カーネル
+ *   周波数グリッドの[begin : end)の点の周波数特性H(e^jω)を計算し，
+ *   re[j - begin], im[j - begin]に書き込む
+ *
+ *     H = a0 * Π(1 + a1 e^-jω + a2 e^-j2ω) / Π(1 + b1 e^-jω + b2 e^-j2ω)
+ *
+ *   SimdNativeの幅で処理し，端数はスカラー版で処理する
+ *   std::complexによる計算とは演算順序が異なるため，
+ *   結果は相対誤差1e-12程度の範囲で一致する
+ *
+ * # 引数
+ * double* coef : 係数列(a0, a1, a2[0], a2[1],..., b1, b2[0], b2[1],...)
+ * unsigned int n_order : 分子次数
+ * unsigned int m_order : 分母次数
+ * FreqGrid& grid : 周波数グリッド
+ * unsigned int begin, end : 計算する周波数点の範囲
+ * double* re, im : 周波数特性の実部・虚部の出力
+ */
+template <typename Order>
+void cascade_res
+(const double* coef, const unsigned int n_order, const unsigned int m_order,
+	const FreqGrid& grid, const unsigned int begin, const unsigned int end,
+	double* re, double* im)
+{
+	const double* c1r = grid.csw_re.data();
+	const double* c1i = grid.csw_im.data();
+	const double* c2r = grid.csw2_re.data();
+	const double* c2i = grid.csw2_im.data();
+
+	unsigned int j = begin;
+	for (; j + SimdNative::width <= end; j += SimdNative::width)
+	{
+		SimdNative::reg hr, hi;
+		Order::template block<SimdNative>(coef, n_order, m_order,
+			c1r + j, c1i + j, c2r + j, c2i + j, hr, hi);
+		SimdNative::store(re + (j - begin), hr);
+		SimdNative::store(im + (j - begin), hi);
+	}
+	for (; j < end; ++j)
+	{
+		SimdScalar::reg hr, hi;
+		Order::template block<SimdScalar>(coef, n_order, m_order,
+			c1r + j, c1i + j, c2r + j, c2i + j, hr, hi);
+		re[j - begin] = hr;
+		im[j - begin] = hi;
+	}
+}
+
+/* # 縦続型IIRフィルタの誤差カーネル(通過域・阻止域)
+ *   周波数グリッドの[begin : end)の点について，所望特性との誤差|D - H|の
+ *   最大値でmax_errorを更新する。周波数特性は保存しない
+ */
+template <typename Order>
+void cascade_error
+(const double* coef, const unsigned int n_order, const unsigned int m_order,
+	const FreqGrid& grid, const unsigned int begin, const unsigned int end,
+	double& max_error)
+{
+	typedef SimdNative V;
+	const double* c1r = grid.csw_re.data();
+	const double* c1i = grid.csw_im.data();
+	const double* c2r = grid.csw2_re.data();
+	const double* c2i = grid.csw2_im.data();
+	const double* dsr = grid.desire_re.data();
+	const double* dsi = grid.desire_im.data();
+
+	V::reg vmax = V::set1(max_error);
+	unsigned int j = begin;
+	for (; j + V::width <= end; j += V::width)
+	{
+		V::reg hr, hi;
+		Order::template block<V>(coef, n_order, m_order,
+			c1r + j, c1i + j, c2r + j, c2i + j, hr, hi);
+		const V::reg er = V::sub(V::load(dsr + j), hr);
+		const V::reg ei = V::sub(V::load(dsi + j), hi);
+		vmax = V::max(vmax, V::sqrt(V::fmadd(er, er, V::mul(ei, ei))));
+	}
+	max_error = V::hmax(vmax);
+	for (; j < end; ++j)
+	{
+		double hr, hi;
+		Order::template block<SimdScalar>(coef, n_order, m_order,
+			c1r + j, c1i + j, c2r + j, c2i + j, hr, hi);
+		const double er = dsr[j] - hr;
+		const double ei = dsi[j] - hi;
+		max_error = max(max_error, std::sqrt(er*er + ei*ei));
+	}
+}
+
+/* # 縦続型IIRフィルタの振幅隆起カーネル(遷移域)
+ *   周波数グリッドの[begin : end)の点について，振幅|H|がthresholdを超えた
+ *   ものの最大値でmax_ripleを更新する。周波数特性は保存しない
+ */
+template <typename Order>
+void cascade_riple
+(const double* coef, const unsigned int n_order, const unsigned int m_order,
+	const FreqGrid& grid, const unsigned int begin, const unsigned int end,
+	const double threshold, double& max_riple)
+{
+	typedef SimdNative V;
+	const double* c1r = grid.csw_re.data();
+	const double* c1i = grid.csw_im.data();
+	const double* c2r = grid.csw2_re.data();
+	const double* c2i = grid.csw2_im.data();
+
+	const V::reg vthreshold = V::set1(threshold);
+	V::reg vmax = V::set1(max_riple);
+	unsigned int j = begin;
+	for (; j + V::width <= end; j += V::width)
+	{
+		V::reg hr, hi;
+		Order::template block<V>(coef, n_order, m_order,
+			c1r + j, c1i + j, c2r + j, c2i + j, hr, hi);
+		const V::reg amp = V::sqrt(V::fmadd(hr, hr, V::mul(hi, hi)));
+		vmax = V::max(vmax, V::keep_gt(amp, vthreshold));
+	}
+	max_riple = V::hmax(vmax);
+	for (; j < end; ++j)
+	{
+		double hr, hi;
+		Order::template block<SimdScalar>(coef, n_order, m_order,
+			c1r + j, c1i + j, c2r + j, c2i + j, hr, hi);
+		const double amp = std::sqrt(hr*hr + hi*hi);
+		if (amp > threshold && amp > max_riple)
+		{
+			max_riple = amp;
+		}
+	}
+}
+
+/* # 縦続型IIRフィルタの誤差・群遅延偏差カーネル(通過域)
+ *   周波数グリッドの[begin : end)の点について，所望特性との誤差|D - H|の最大値で
+ *   max_errorを，群遅延と所望群遅延targetの差の最大値でmax_gdを更新する
+ *   周波数特性と群遅延はcascade_res_gdと同じ1回の節の走査で求める
+ */
+template <typename Order>
+void cascade_error_gd
+(const double* coef, const unsigned int n_order, const unsigned int m_order,
+	const FreqGrid& grid, const unsigned int begin, const unsigned int end,
+	const double target, double& max_error, double& max_gd)
+{
+	typedef SimdNative V;
+	const double* c1r = grid.csw_re.data();
+	const double* c1i = grid.csw_im.data();
+	const double* c2r = grid.csw2_re.data();
+	const double* c2i = grid.csw2_im.data();
+	const double* dsr = grid.desire_re.data();
+	const double* dsi = grid.desire_im.data();
+
+	const V::reg vtarget = V::set1(target);
+	V::reg vmax = V::set1(max_error);
+	V::reg vmax_gd = V::set1(max_gd);
+	unsigned int j = begin;
+	for (; j + V::width <= end; j += V::width)
+	{
+		V::reg hr, hi, tau;
+		Order::template block_gd<V>(coef, n_order, m_order,
+			c1r + j, c1i + j, c2r + j, c2i + j, hr, hi, tau);
+		const V::reg er = V::sub(V::load(dsr + j), hr);
+		const V::reg ei = V::sub(V::load(dsi + j), hi);
+		vmax = V::max(vmax, V::sqrt(V::fmadd(er, er, V::mul(ei, ei))));
+		const V::reg dev = V::sub(tau, vtarget);
+		vmax_gd = V::max(vmax_gd, V::max(dev, V::sub(V::zero(), dev)));
+	}
+	max_error = V::hmax(vmax);
+	max_gd = V::hmax(vmax_gd);
+	for (; j < end; ++j)
+	{
+		double hr, hi, tau;
+		Order::template block_gd<SimdScalar>(coef, n_order, m_order,
+			c1r + j, c1i + j, c2r + j, c2i + j, hr, hi, tau);
+		const double er = dsr[j] - hr;
+		const double ei = dsi[j] - hi;
+		max_error = max(max_error, std::sqrt(er*er + ei*ei));
+		max_gd = max(max_gd, std::abs(tau - target));
+	}
+}
+
+/* # 縦続型IIRフィルタの評価カーネル
+ *   周波数特性を1点ずつ計算しながら，帯域の種類に応じて
+ *   通過域・阻止域の最大誤差と遷移域の最大振幅隆起を同じループで更新する
+ *   周波数特性の配列は作らない
+ */
+template <typename Order>
+void cascade_eval
+(const double* coef, const unsigned int n_order, const unsigned int m_order,
+	const FreqGrid& grid, const double threshold, double& max_error, double& max_riple)
+{
+	for (unsigned int i = 0; i < grid.nband(); ++i)    // 周波数帯域のループ
+	{
+		if (grid.band_size(i) == 0)
+		{
+			continue;
+		}
+
+		switch (grid.band_type[grid.band_begin(i)])
+		{
+			case BandType::Pass:
+			case BandType::Stop:
+			{
+				cascade_error<Order>(coef, n_order, m_order, grid,
+					grid.band_begin(i), grid.band_end(i), max_error);
+				break;
+			}
+			case BandType::Transition:
+			{
+				cascade_riple<Order>(coef, n_order, m_order, grid,
+					grid.band_begin(i), grid.band_end(i), threshold, max_riple);
+				break;
+			}
+		}
+	}
+}
+
+/* # 縦続型IIRフィルタの周波数特性・群遅延の複合カーネル
+ *   周波数グリッドの[begin : end)の点の周波数特性と群遅延を1回の節の走査で計算し，
+ *   re[j - begin], im[j - begin], gd[j - begin]に書き込む
+ *   (re, imがnullptrの場合は群遅延のみ書き込む)
+ *
+ *   各節 S = 1 + c1 e^-jω + c2 e^-j2ω の群遅延への寄与は Re{P / S}
+ *   (P = c1 e^-jω + 2 c2 e^-j2ω，分子は加算，分母は減算)
+ *   節ごとに除算せず，総乗Πと積の微分Q = Σ P_k Π_{i≠k} S_i を同時に更新し，
+ *   最後に Re{Q_N / N} - Re{Q_D / D} として求める
+ *   各節のSは周波数特性と群遅延で共有し，|D|^2も共有する
+ */
+template <typename Order>
+void cascade_res_gd
+(const double* coef, const unsigned int n_order, const unsigned int m_order,
+	const FreqGrid& grid, const unsigned int begin, const unsigned int end,
+	double* re, double* im, double* gd)
+{
+	const double* c1r = grid.csw_re.data();
+	const double* c1i = grid.csw_im.data();
+	const double* c2r = grid.csw2_re.data();
+	const double* c2i = grid.csw2_im.data();
+
+	unsigned int j = begin;
+	for (; j + SimdNative::width <= end; j += SimdNative::width)
+	{
+		SimdNative::reg hr, hi, tau;
+		Order::template block_gd<SimdNative>(coef, n_order, m_order,
+			c1r + j, c1i + j, c2r + j, c2i + j, hr, hi, tau);
+		if (re != nullptr)
+		{
+			SimdNative::store(re + (j - begin), hr);
+			SimdNative::store(im + (j - begin), hi);
+		}
+		SimdNative::store(gd + (j - begin), tau);
+	}
+	for (; j < end; ++j)
+	{
+		SimdScalar::reg hr, hi, tau;
+		Order::template block_gd<SimdScalar>(coef, n_order, m_order,
+			c1r + j, c1i + j, c2r + j, c2i + j, hr, hi, tau);
+		if (re != nullptr)
+		{
+			re[j - begin] = hr;
+			im[j - begin] = hi;
+		}
+		gd[j - begin] = tau;
+	}
+}
+
+/* # 縦続型IIRフィルタの評価カーネル(通過域の群遅延偏差つき)
+ *   cascade_evalに加え，通過域では群遅延と所望群遅延targetの差の最大値で
+ *   max_gdを更新する。通過域は周波数特性と群遅延を1回の走査で求め，
+ *   阻止域・遷移域はcascade_evalと同じく周波数特性のみを計算する
+ */
+template <typename Order>
+void cascade_eval_gd
+(const double* coef, const unsigned int n_order, const unsigned int m_order,
+	const FreqGrid& grid, const double threshold, const double target,
+	double& max_error, double& max_riple, double& max_gd)
+{
+	for (unsigned int i = 0; i < grid.nband(); ++i)    // 周波数帯域のループ
+	{
+		if (grid.band_size(i) == 0)
+		{
+			continue;
+		}
+
+		switch (grid.band_type[grid.band_begin(i)])
+		{
+			case BandType::Pass:
+			{
+				cascade_error_gd<Order>(coef, n_order, m_order, grid,
+					grid.band_begin(i), grid.band_end(i), target, max_error, max_gd);
+				break;
+			}
+			case BandType::Stop:
+			{
+				cascade_error<Order>(coef, n_order, m_order, grid,
+					grid.band_begin(i), grid.band_end(i), max_error);
+				break;
+			}
+			case BandType::Transition:
+			{
+				cascade_riple<Order>(coef, n_order, m_order, grid,
+					grid.band_begin(i), grid.band_end(i), threshold, max_riple);
+				break;
+			}
+		}
+	}
+}
+
+/* # 縦続型IIRフィルタの振幅2乗特性カーネル
+ *   周波数グリッドの[begin : end)の点の|H|^2を計算し，power[j - begin]に書き込む
+ *
+ *     |H|^2 = a0^2 * Π|1 + a1 e^-jω + a2 e^-j2ω|^2 / Π|1 + b1 e^-jω + b2 e^-j2ω|^2
+ *
+ *   各節は cosω(csw_re), cos2ω(csw2_re)の表を使った実数の多項式で計算し，
+ *   複素数の除算は行わない(実数の除算が1点につき1回)
+ */
+template <typename Order>
+void cascade_power
+(const double* coef, const unsigned int n_order, const unsigned int m_order,
+	const FreqGrid& grid, const unsigned int begin, const unsigned int end,
+	double* power)
+{
+	const double* cw = grid.csw_re.data();
+	const double* c2w = grid.csw2_re.data();
+
+	unsigned int j = begin;
+	for (; j + SimdNative::width <= end; j += SimdNative::width)
+	{
+		SimdNative::reg p;
+		Order::template block_power<SimdNative>(coef, n_order, m_order, cw + j, c2w + j, p);
+		SimdNative::store(power + (j - begin), p);
+	}
+	for (; j < end; ++j)
+	{
+		SimdScalar::reg p;
+		Order::template block_power<SimdScalar>(coef, n_order, m_order, cw + j, c2w + j, p);
+		power[j - begin] = p;
+	}
+}
+
+/* # 縦続型IIRフィルタの振幅誤差カーネル(通過域・阻止域)
+ *   周波数グリッドの[begin : end)の点について，所望振幅との誤差||D| - |H||の
+ *   最大値でmax_errorを更新する
+ */
+template <typename Order>
+void cascade_error_mag
+(const double* coef, const unsigned int n_order, const unsigned int m_order,
+	const FreqGrid& grid, const unsigned int begin, const unsigned int end,
+	double& max_error)
+{
+	typedef SimdNative V;
+	const double* cw = grid.csw_re.data();
+	const double* c2w = grid.csw2_re.data();
+	const double* dsm = grid.desire_mag.data();
+
+	V::reg vmax = V::set1(max_error);
+	unsigned int j = begin;
+	for (; j + V::width <= end; j += V::width)
+	{
+		V::reg p;
+		Order::template block_power<V>(coef, n_order, m_order, cw + j, c2w + j, p);
+		const V::reg e = V::sub(V::load(dsm + j), V::sqrt(p));
+		vmax = V::max(vmax, V::max(e, V::sub(V::zero(), e)));
+	}
+	max_error = V::hmax(vmax);
+	for (; j < end; ++j)
+	{
+		double p;
+		Order::template block_power<SimdScalar>(coef, n_order, m_order, cw + j, c2w + j, p);
+		max_error = max(max_error, std::abs(dsm[j] - std::sqrt(p)));
+	}
+}
+
+/* # 縦続型IIRフィルタの振幅隆起カーネル(遷移域，実数演算版)
+ *   cascade_ripleと同じ値を返すが，|H|^2をthreshold^2と比較し，
+ *   平方根は最大値に対してだけ計算する
+ */
+template <typename Order>
+void cascade_riple_mag
+(const double* coef, const unsigned int n_order, const unsigned int m_order,
+	const FreqGrid& grid, const unsigned int begin, const unsigned int end,
+	const double threshold, double& max_riple)
+{
+	typedef SimdNative V;
+	const double* cw = grid.csw_re.data();
+	const double* c2w = grid.csw2_re.data();
+
+	const V::reg vthreshold = V::set1(threshold*threshold);
+	V::reg vmax = V::set1(max_riple*max_riple);
+	unsigned int j = begin;
+	for (; j + V::width <= end; j += V::width)
+	{
+		V::reg p;
+		Order::template block_power<V>(coef, n_order, m_order, cw + j, c2w + j, p);
+		vmax = V::max(vmax, V::keep_gt(p, vthreshold));
+	}
+	double max_power = V::hmax(vmax);
+	for (; j < end; ++j)
+	{
+		double p;
+		Order::template block_power<SimdScalar>(coef, n_order, m_order, cw + j, c2w + j, p);
+		if (p > threshold*threshold && p > max_power)
+		{
+			max_power = p;
+		}
+	}
+	max_riple = std::sqrt(max_power);
+}
+
+/* # 縦続型IIRフィルタの評価カーネル(振幅のみ)
+ *   EvalMode::Magnitude用。cascade_evalと同じ帯域ごとの分岐で，
+ *   通過域・阻止域の最大振幅誤差と遷移域の最大振幅隆起を実数演算のみで更新する
+ */
+template <typename Order>
+void cascade_eval_mag
+(const double* coef, const unsigned int n_order, const unsigned int m_order,
+	const FreqGrid& grid, const double threshold, double& max_error, double& max_riple)
+{
+	for (unsigned int i = 0; i < grid.nband(); ++i)    // 周波数帯域のループ
+	{
+		if (grid.band_size(i) == 0)
+		{
+			continue;
+		}
+
+		switch (grid.band_type[grid.band_begin(i)])
+		{
+			case BandType::Pass:
+			case BandType::Stop:
+			{
+				cascade_error_mag<Order>(coef, n_order, m_order, grid,
+					grid.band_begin(i), grid.band_end(i), max_error);
+				break;
+			}
+			case BandType::Transition:
+			{
+				cascade_riple_mag<Order>(coef, n_order, m_order, grid,
+					grid.band_begin(i), grid.band_end(i), threshold, max_riple);
+				break;
+			}
+		}
+	}
+}
+
+/* # 候補解方向にSIMD化したカーネルの部品
+ *   V::width個の候補解の係数をAoSoA(Array of Structures of Arrays)の配置
+ *     lanes[i*V::width + l] : 候補解lの係数i
+ *   で受け取り，1つの周波数点でV::width個の候補解を同時に計算する
+ *   周波数点のe^-jω, e^-j2ωは全レーンに複製して共有する
+ *   各レーンの演算順序はDynamicOrderのblockと同じ
+ */
+template <typename V, bool OddN, bool OddM>
+struct CandidateLanes
+{
+	static SIMD_INLINE void block
+	(const double* lanes, const unsigned int n_order, const unsigned int m_order,
+		const FreqGrid& grid, const unsigned int j, typename V::reg& re, typename V::reg& im)
+	{
+		typedef typename V::reg reg;
+		const unsigned int w = V::width;
+
+		const reg z1r = V::set1(grid.csw_re[j]);
+		const reg z1i = V::set1(grid.csw_im[j]);
+		const reg z2r = V::set1(grid.csw2_re[j]);
+		const reg z2i = V::set1(grid.csw2_im[j]);
+
+		reg nr = V::set1(1.0);
+		reg ni = V::zero();
+		unsigned int n = 1;
+		if (OddN)
+		{
+			first_section_reg<V>(V::load(lanes + w), z1r, z1i, nr, ni);
+			n = 2;
+		}
+		for (; n < n_order; n += 2)
+		{
+			mul_section_reg<V>(V::load(lanes + n*w), V::load(lanes + (n + 1)*w),
+				z1r, z1i, z2r, z2i, nr, ni);
+		}
+
+		const unsigned int opt_order = 1 + n_order + m_order;
+		reg dr = V::set1(1.0);
+		reg di = V::zero();
+		unsigned int m = n_order + 1;
+		if (OddM)
+		{
+			first_section_reg<V>(V::load(lanes + m*w), z1r, z1i, dr, di);
+			m = n_order + 2;
+		}
+		for (; m < opt_order; m += 2)
+		{
+			mul_section_reg<V>(V::load(lanes + m*w), V::load(lanes + (m + 1)*w),
+				z1r, z1i, z2r, z2i, dr, di);
+		}
+
+		divide_res_reg<V>(V::load(lanes), nr, ni, dr, di, re, im);
+	}
+};
+
+/* # 候補解方向にSIMD化した評価カーネル
+ *   AoSoAに並べたSimdNative::width個の候補解について，cascade_evalと同じ
+ *   最大誤差・最大振幅隆起をレーンごとにmax_error[l], max_riple[l]へ書き込む
+ *   帯域の端でレーンが余らないため，周波数点の少ないグリッドや低次のフィルタで有利
+ */
+template <bool OddN, bool OddM>
+void cascade_eval_lanes
+(const double* lanes, const unsigned int n_order, const unsigned int m_order,
+	const FreqGrid& grid, const double threshold, double* max_error, double* max_riple)
+{
+	typedef SimdNative V;
+	typedef CandidateLanes<V, OddN, OddM> Lanes;
+	const double* dsr = grid.desire_re.data();
+	const double* dsi = grid.desire_im.data();
+
+	const V::reg vthreshold = V::set1(threshold);
+	V::reg vmax = V::zero();
+	V::reg vriple = V::zero();
+	for (unsigned int i = 0; i < grid.nband(); ++i)    // 周波数帯域のループ
+	{
+		if (grid.band_size(i) == 0)
+		{
+			continue;
+		}
+
+		if (grid.band_type[grid.band_begin(i)] == BandType::Transition)
+		{
+			for (unsigned int j = grid.band_begin(i); j < grid.band_end(i); ++j)
+			{
+				V::reg hr, hi;
+				Lanes::block(lanes, n_order, m_order, grid, j, hr, hi);
+				const V::reg amp = V::sqrt(V::fmadd(hr, hr, V::mul(hi, hi)));
+				vriple = V::max(vriple, V::keep_gt(amp, vthreshold));
+			}
+		}
+		else
+		{
+			for (unsigned int j = grid.band_begin(i); j < grid.band_end(i); ++j)
+			{
+				V::reg hr, hi;
+				Lanes::block(lanes, n_order, m_order, grid, j, hr, hi);
+				const V::reg er = V::sub(V::set1(dsr[j]), hr);
+				const V::reg ei = V::sub(V::set1(dsi[j]), hi);
+				vmax = V::max(vmax, V::sqrt(V::fmadd(er, er, V::mul(ei, ei))));
+			}
+		}
+	}
+	V::store(max_error, vmax);
+	V::store(max_riple, vriple);
+}
+
+/* # 候補解方向にSIMD化した評価カーネル(振幅のみ)
+ *   cascade_eval_magと同じ値をレーンごとに書き込む
+ *   各節の|S|^2 = k0 + k1 cosω + k2 cos2ωの係数は周波数点によらないため，
+ *   先にwork[(3s + t)*width + l](節s，係数kt，レーンl)へ計算しておく
+ *   (1次の節はk2 = 0の2次の節として扱う。work[0 : width)はa0^2)
+ *   workは(1 + 3 x 節の数) x width要素以上であること(3 x opt_order x widthで足りる)
+ */
+template <bool OddN, bool OddM>
+void cascade_eval_mag_lanes
+(const double* lanes, const unsigned int n_order, const unsigned int m_order,
+	const FreqGrid& grid, const double threshold, double* work, double* max_error, double* max_riple)
+{
+	typedef SimdNative V;
+	const unsigned int w = V::width;
+	const double* dsm = grid.desire_mag.data();
+
+	// 分子・分母の順に節の係数を並べる
+	const unsigned int nzero = (n_order + 1)/2;
+	unsigned int nsec = 0;
+	for (unsigned int l = 0; l < w; ++l)
+	{
+		work[l] = lanes[l]*lanes[l];
+	}
+	for (unsigned int n = 1; n <= n_order + m_order; ++nsec)
+	{
+		const bool single = (OddN && n == 1) || (OddM && n == n_order + 1);
+		const double* c = lanes + n*w;
+		double* k = work + (1 + 3*nsec)*w;
+		for (unsigned int l = 0; l < w; ++l)
+		{
+			const double c1 = c[l];
+			const double c2 = single ? 0.0 : c[w + l];
+			k[l] = 1.0 + c1*c1 + c2*c2;
+			k[w + l] = 2.0*c1*(1.0 + c2);
+			k[2*w + l] = 2.0*c2;
+		}
+		n += single ? 1 : 2;
+	}
+
+	const V::reg vthreshold = V::set1(threshold*threshold);
+	V::reg vmax = V::zero();
+	V::reg vriple = V::zero();
+	for (unsigned int i = 0; i < grid.nband(); ++i)    // 周波数帯域のループ
+	{
+		const bool transition = grid.band_size(i) > 0 && grid.band_type[grid.band_begin(i)] == BandType::Transition;
+		for (unsigned int j = grid.band_begin(i); j < grid.band_end(i); ++j)
+		{
+			const V::reg cw = V::set1(grid.csw_re[j]);
+			const V::reg c2w = V::set1(grid.csw2_re[j]);
+			V::reg pn = V::set1(1.0);
+			V::reg pd = V::set1(1.0);
+			const double* k = work + w;
+			for (unsigned int s = 0; s < nzero; ++s, k += 3*w)
+			{
+				pn = V::mul(pn, V::fmadd(V::load(k + 2*w), c2w, V::fmadd(V::load(k + w), cw, V::load(k))));
+			}
+			for (unsigned int s = nzero; s < nsec; ++s, k += 3*w)
+			{
+				pd = V::mul(pd, V::fmadd(V::load(k + 2*w), c2w, V::fmadd(V::load(k + w), cw, V::load(k))));
+			}
+			const V::reg p = V::div(V::mul(V::load(work), pn), pd);
+
+			if (transition)
+			{
+				vriple = V::max(vriple, V::keep_gt(p, vthreshold));
+			}
+			else
+			{
+				const V::reg e = V::sub(V::set1(dsm[j]), V::sqrt(p));
+				vmax = V::max(vmax, V::max(e, V::sub(V::zero(), e)));
+			}
+		}
+	}
+	V::store(max_error, vmax);
+	V::store(max_riple, V::sqrt(vriple));
+}
+
+/* # 縦続型IIRフィルタの群遅延特性カーネル
+ *   周波数グリッドの[begin : end)の点の群遅延を計算し，gd[j - begin]に書き込む
+ *   複合カーネルcascade_res_gdの群遅延のみを使う
+ */
+template <typename Order>
+void cascade_gd
+(const double* coef, const unsigned int n_order, const unsigned int m_order,
+	const FreqGrid& grid, const unsigned int begin, const unsigned int end,
+	double* gd)
+{
+	cascade_res_gd<Order>(coef, n_order, m_order, grid, begin, end, nullptr, nullptr, gd);
+}
+
+/* # 縦続型IIRフィルタの節の値
+ *   (sr + j si) = 1 + c1 e^-jω + c2 e^-j2ω
+ */
+template <typename V>
+SIMD_INLINE void section_value
+(const double c1, const double c2,
+	const typename V::reg& z1r, const typename V::reg& z1i,
+	const typename V::reg& z2r, const typename V::reg& z2i,
+	typename V::reg& sr, typename V::reg& si)
+{
+	const typename V::reg v1 = V::set1(c1);
+	const typename V::reg v2 = V::set1(c2);
+	sr = V::fmadd(v2, z2r, V::fmadd(v1, z1r, V::set1(1.0)));
+	si = V::fmadd(v2, z2i, V::mul(v1, z1i));
+}
+
+/* # 縦続型IIRフィルタの残差とヤコビ行列の1ブロック
+ *   周波数点jからV::width点の残差 r = H - D と微分 ∂H/∂coef[k] を計算する
+ *   係数kの微分はjac[k*stride + j](実部)，jac[k*stride + half + j](虚部)に書き込む
+ *   1回目の節の走査で各節の値Sをc1の行に一時的に置いて総乗を取り，
+ *   2回目の走査で対数微分 ∂ln H/∂c1 = ±e^-jω / S，∂ln H/∂c2 = ±e^-j2ω / S
+ *   (分子は+，分母は-)にHを掛けた値に置き換える
+ */
+template <typename V, bool OddN, bool OddM>
+SIMD_INLINE void res_jac_block
+(const double* coef, const unsigned int n_order, const unsigned int m_order,
+	const FreqGrid& grid, const unsigned int j, const unsigned int half, const unsigned int stride,
+	double* res, double* jac)
+{
+	typedef typename V::reg reg;
+
+	const reg z1r = V::load(grid.csw_re.data() + j);
+	const reg z1i = V::load(grid.csw_im.data() + j);
+	const reg z2r = V::load(grid.csw2_re.data() + j);
+	const reg z2i = V::load(grid.csw2_im.data() + j);
+	const unsigned int opt_order = 1 + n_order + m_order;
+
+	// 1回目 : 節の値Sを置き，分子Nと分母Dの総乗を取る
+	reg nr = V::set1(1.0), ni = V::zero();
+	reg dr = V::set1(1.0), di = V::zero();
+	for (unsigned int k = 1; k < opt_order; )
+	{
+		const bool numerator = k <= n_order;
+		const bool first = (numerator && OddN && k == 1) || (!numerator && OddM && k == n_order + 1);
+		reg sr, si;
+		section_value<V>(coef[k], first ? 0.0 : coef[k + 1], z1r, z1i, z2r, z2i, sr, si);
+		V::store(jac + (size_t)k*stride + j, sr);
+		V::store(jac + (size_t)k*stride + half + j, si);
+
+		reg& pr = numerator ? nr : dr;
+		reg& pi = numerator ? ni : di;
+		const reg tr = V::fnmadd(pi, si, V::mul(pr, sr));
+		pi = V::fmadd(pi, sr, V::mul(pr, si));
+		pr = tr;
+		k += first ? 1 : 2;
+	}
+
+	// H0 = N / D，H = a0 H0，∂H/∂a0 = H0
+	const reg dnorm = V::fmadd(dr, dr, V::mul(di, di));
+	const reg h0r = V::div(V::fmadd(nr, dr, V::mul(ni, di)), dnorm);
+	const reg h0i = V::div(V::fnmadd(nr, di, V::mul(ni, dr)), dnorm);
+	const reg a0 = V::set1(coef[0]);
+	const reg hr = V::mul(a0, h0r);
+	const reg hi = V::mul(a0, h0i);
+	V::store(jac + j, h0r);
+	V::store(jac + half + j, h0i);
+	V::store(res + j, V::sub(hr, V::load(grid.desire_re.data() + j)));
+	V::store(res + half + j, V::sub(hi, V::load(grid.desire_im.data() + j)));
+
+	// 2回目 : G = ±H / S として ∂H/∂c1 = G e^-jω，∂H/∂c2 = G e^-j2ω
+	for (unsigned int k = 1; k < opt_order; )
+	{
+		const bool numerator = k <= n_order;
+		const bool first = (numerator && OddN && k == 1) || (!numerator && OddM && k == n_order + 1);
+		double* row_re = jac + (size_t)k*stride + j;
+		double* row_im = jac + (size_t)k*stride + half + j;
+		const reg sr = V::load(row_re);
+		const reg si = V::load(row_im);
+		const reg scale = V::div(V::set1(numerator ? 1.0 : -1.0), V::fmadd(sr, sr, V::mul(si, si)));
+		const reg gr = V::mul(V::fmadd(hr, sr, V::mul(hi, si)), scale);
+		const reg gi = V::mul(V::fnmadd(hr, si, V::mul(hi, sr)), scale);
+
+		V::store(row_re, V::fnmadd(gi, z1i, V::mul(gr, z1r)));
+		V::store(row_im, V::fmadd(gi, z1r, V::mul(gr, z1i)));
+		if (!first)
+		{
+			V::store(row_re + stride, V::fnmadd(gi, z2i, V::mul(gr, z2r)));
+			V::store(row_im + stride, V::fmadd(gi, z2r, V::mul(gr, z2i)));
+		}
+		k += first ? 1 : 2;
+	}
+}
+
+/* # 縦続型IIRフィルタの残差・ヤコビ行列カーネル
+ *   周波数グリッドの全P点について，残差 r = H - D を実部・虚部の順に
+ *   res[0 : P), res[P : 2P)へ，∂r/∂coef[k]を行kとしてjac[k*2P : (k + 1)*2P)へ書き込む
+ *   周波数特性と同じ節の走査で微分を求め，節ごとの微分の周波数特性を別に計算しない
+ *   遷移域の所望特性は0として扱う
+ *   OddN, OddMはDynamicOrderと同じ(ヤコビ行列の書き込みが支配的なため次数固定版は持たない)
+ */
+template <bool OddN, bool OddM>
+void cascade_res_jac
+(const double* coef, const unsigned int n_order, const unsigned int m_order,
+	const FreqGrid& grid, double* res, double* jac)
+{
+	const unsigned int npoint = grid.size();
+	const unsigned int stride = 2*npoint;
+
+	unsigned int j = 0;
+	for (; j + SimdNative::width <= npoint; j += SimdNative::width)
+	{
+		res_jac_block<SimdNative, OddN, OddM>(coef, n_order, m_order, grid, j, npoint, stride, res, jac);
+	}
+	for (; j < npoint; ++j)
+	{
+		res_jac_block<SimdScalar, OddN, OddM>(coef, n_order, m_order, grid, j, npoint, stride, res, jac);
+	}
+}
+
+/* 滑らかな最大値(p乗平均ノルム)の累積値
+ *   点ごとの値uについて，これまでの最大値scaleで割ったr = u/scaleの冪を
+ *   SimdNative::widthのレーンごとに累積する(scaleが増えたときは累積値を縮める)
+ *
+ *   scale : これまでのuの最大値M
+ *   npoint : 累積した点数
+ *   sum : Σ r^p(レーンごと)
+ *   grad : Σ r^(p-1) ∂u/∂coef[k](係数kのレーンがgrad[k*width : (k + 1)*width))
+ */
+struct SmoothNorm
+{
+	double scale;
+	unsigned int npoint;
+	double* sum;
+	double* grad;
+
+	void rescale(const double, const unsigned int, const unsigned int);
+};
+
+/* # 滑らかな最大値の累積値
+ *   最大値をnew_scaleに増やし，累積値に(scale/new_scale)^p, ^(p-1)を掛ける
+ */
+inline void SmoothNorm::rescale(const double new_scale, const unsigned int p, const unsigned int opt_order)
+{
+	const double ratio = scale/new_scale;
+	const double fsum = pow(ratio, (double)p);
+	const double fgrad = pow(ratio, (double)(p - 1));
+	for (unsigned int l = 0; l < SimdNative::width; ++l)
+	{
+		sum[l] *= fsum;
+	}
+	for (unsigned int k = 0; k < opt_order*SimdNative::width; ++k)
+	{
+		grad[k] *= fgrad;
+	}
+	scale = new_scale;
+}
+
+/* # 縦続型IIRフィルタの滑らかな最大値の1ブロック
+ *   周波数点jからV::width点について，通過域・阻止域では誤差u = |H - D|を，
+ *   遷移域(riple == true)では振幅の超過分u = max(|H| - threshold, 0)を求め，
+ *   p = 2^log2p乗の累積値と勾配の累積値をaccに加える
+ *   r^pとr^(p-2)はr^2の2乗の繰り返しで求め，指数・対数関数を使わない
+ *   勾配はres_jac_blockと同じ節ごとの対数微分から求め，ヤコビ行列は作らない
+ *   secは節の値Sの一時領域(2 x opt_order x V::width要素)
+ */
+template <typename V, bool OddN, bool OddM>
+SIMD_INLINE void smooth_block
+(const double* coef, const unsigned int n_order, const unsigned int m_order,
+	const FreqGrid& grid, const unsigned int j, const bool riple, const double threshold,
+	const unsigned int log2p, double* sec, SmoothNorm& acc)
+{
+	typedef typename V::reg reg;
+
+	const reg z1r = V::load(grid.csw_re.data() + j);
+	const reg z1i = V::load(grid.csw_im.data() + j);
+	const reg z2r = V::load(grid.csw2_re.data() + j);
+	const reg z2i = V::load(grid.csw2_im.data() + j);
+	const unsigned int opt_order = 1 + n_order + m_order;
+
+	// 1回目 : 節の値Sを置き，分子Nと分母Dの総乗を取る
+	reg nr = V::set1(1.0), ni = V::zero();
+	reg dr = V::set1(1.0), di = V::zero();
+	for (unsigned int k = 1; k < opt_order; )
+	{
+		const bool numerator = k <= n_order;
+		const bool first = (numerator && OddN && k == 1) || (!numerator && OddM && k == n_order + 1);
+		reg sr, si;
+		section_value<V>(coef[k], first ? 0.0 : coef[k + 1], z1r, z1i, z2r, z2i, sr, si);
+		V::store(sec + 2*k*V::width, sr);
+		V::store(sec + (2*k + 1)*V::width, si);
+
+		reg& pr = numerator ? nr : dr;
+		reg& pi = numerator ? ni : di;
+		const reg tr = V::fnmadd(pi, si, V::mul(pr, sr));
+		pi = V::fmadd(pi, sr, V::mul(pr, si));
+		pr = tr;
+		k += first ? 1 : 2;
+	}
+
+	const reg dnorm = V::fmadd(dr, dr, V::mul(di, di));
+	const reg h0r = V::div(V::fmadd(nr, dr, V::mul(ni, di)), dnorm);
+	const reg h0i = V::div(V::fnmadd(nr, di, V::mul(ni, dr)), dnorm);
+	const reg a0 = V::set1(coef[0]);
+	const reg hr = V::mul(a0, h0r);
+	const reg hi = V::mul(a0, h0i);
+
+	// 点ごとの値uと，微分の向きv(∂u/∂c = Re{conj(v) ∂H/∂c} / |v|)
+	reg u, vr, vi;
+	if (riple)
+	{
+		const reg amp = V::sqrt(V::fmadd(hr, hr, V::mul(hi, hi)));
+		u = V::keep_gt(V::sub(amp, V::set1(threshold)), V::zero());
+		const reg inv = V::div(V::set1(1.0), V::max(amp, V::set1(numeric_limits<double>::min())));
+		vr = V::mul(hr, inv);
+		vi = V::mul(hi, inv);
+	}
+	else
+	{
+		const reg er = V::sub(hr, V::load(grid.desire_re.data() + j));
+		const reg ei = V::sub(hi, V::load(grid.desire_im.data() + j));
+		u = V::sqrt(V::fmadd(er, er, V::mul(ei, ei)));
+		const reg inv = V::div(V::set1(1.0), V::max(u, V::set1(numeric_limits<double>::min())));
+		vr = V::mul(er, inv);
+		vi = V::mul(ei, inv);
+	}
+
+	const double block_max = V::hmax(u);
+	acc.npoint += V::width;
+	if (block_max > acc.scale)
+	{
+		acc.rescale(block_max, 1u << log2p, opt_order);
+	}
+	if (acc.scale == 0.0)
+	{
+		return;
+	}
+
+	// r^p と r^(p-1) = r^(p-2) r
+	const reg r = V::div(u, V::set1(acc.scale));
+	const reg r2 = V::mul(r, r);
+	reg rp = r2;
+	reg rp2 = V::set1(1.0);
+	for (unsigned int i = 1; i < log2p; ++i)
+	{
+		rp2 = V::mul(rp2, rp);
+		rp = V::mul(rp, rp);
+	}
+	V::store(acc.sum, V::add(V::load(acc.sum), rp));
+	const reg w = V::mul(rp2, r);
+
+	// T = w conj(v) H として ∂H/∂a0 = H0，∂H/∂c = ±(H / S) e^-jkω
+	const reg tr = V::mul(w, V::fmadd(vr, hr, V::mul(vi, hi)));
+	const reg ti = V::mul(w, V::fnmadd(vi, hr, V::mul(vr, hi)));
+	const reg ga0 = V::mul(w, V::fmadd(vr, h0r, V::mul(vi, h0i)));
+	V::store(acc.grad, V::add(V::load(acc.grad), ga0));
+	for (unsigned int k = 1; k < opt_order; )
+	{
+		const bool numerator = k <= n_order;
+		const bool first = (numerator && OddN && k == 1) || (!numerator && OddM && k == n_order + 1);
+		const reg sr = V::load(sec + 2*k*V::width);
+		const reg si = V::load(sec + (2*k + 1)*V::width);
+		const reg scale = V::div(V::set1(numerator ? 1.0 : -1.0), V::fmadd(sr, sr, V::mul(si, si)));
+		const reg qr = V::mul(V::fmadd(tr, sr, V::mul(ti, si)), scale);
+		const reg qi = V::mul(V::fnmadd(tr, si, V::mul(ti, sr)), scale);
+
+		double* g1 = acc.grad + k*SimdNative::width;
+		V::store(g1, V::add(V::load(g1), V::fnmadd(qi, z1i, V::mul(qr, z1r))));
+		if (!first)
+		{
+			double* g2 = g1 + SimdNative::width;
+			V::store(g2, V::add(V::load(g2), V::fnmadd(qi, z2i, V::mul(qr, z2r))));
+		}
+		k += first ? 1 : 2;
+	}
+}
+
+/* # 縦続型IIRフィルタの滑らかな最大値カーネル
+ *   周波数グリッドの全点を1回走査し，通過域・阻止域の誤差の累積値をerror，
+ *   遷移域の振幅の超過分の累積値をripleに加える(値と勾配を同じ走査で求める)
+ *   secは2 x opt_order x SimdNative::width要素の作業領域
+ *   OddN, OddMはDynamicOrderと同じ
+ */
+template <bool OddN, bool OddM>
+void cascade_smooth
+(const double* coef, const unsigned int n_order, const unsigned int m_order,
+	const FreqGrid& grid, const double threshold, const unsigned int log2p,
+	double* sec, SmoothNorm& error, SmoothNorm& riple)
+{
+	for (unsigned int i = 0; i < grid.nband(); ++i)    // 周波数帯域のループ
+	{
+		const unsigned int begin = grid.band_begin(i);
+		const unsigned int end = grid.band_end(i);
+		if (begin == end)
+		{
+			continue;
+		}
+
+		const bool is_riple = grid.band_type[begin] == BandType::Transition;
+		SmoothNorm& acc = is_riple ? riple : error;
+		unsigned int j = begin;
+		for (; j + SimdNative::width <= end; j += SimdNative::width)
+		{
+			smooth_block<SimdNative, OddN, OddM>(coef, n_order, m_order, grid, j, is_riple, threshold,
+				log2p, sec, acc);
+		}
+		for (; j < end; ++j)
+		{
+			smooth_block<SimdScalar, OddN, OddM>(coef, n_order, m_order, grid, j, is_riple, threshold,
+				log2p, sec, acc);
+		}
+	}
+}
+
+/* # カーネルの組の生成
+ *   Orderの方針で生成した各カーネルの関数ポインタをまとめて返す
+ */
+template <typename Order>
+CascadeKernels cascade_kernels()
+{
+	CascadeKernels kernels;
+	kernels.res = &cascade_res<Order>;
+	kernels.gd = &cascade_gd<Order>;
+	kernels.res_gd = &cascade_res_gd<Order>;
+	kernels.eval = &cascade_eval<Order>;
+	kernels.error = &cascade_error<Order>;
+	kernels.riple = &cascade_riple<Order>;
+	kernels.eval_gd = &cascade_eval_gd<Order>;
+	kernels.error_gd = &cascade_error_gd<Order>;
+	kernels.power = &cascade_power<Order>;
+	kernels.eval_mag = &cascade_eval_mag<Order>;
+	kernels.error_mag = &cascade_error_mag<Order>;
+	kernels.riple_mag = &cascade_riple_mag<Order>;
+	return kernels;
+}
+
+/* # 次数固定カーネルの検索
+ *   次数の組がCASCADE_FIXED_ORDER_LISTに含まれるか，
+ *   CASCADE_FIXED_ORDER_MAXが定義されていて分子・分母次数がともにそれ以下のとき，
+ *   FixedOrder<n_order, m_order>のカーネルをkernelsに設定してtrueを返す
+ *   それ以外はfalseを返す(kernelsは変更しない)
+ *   (cascade_fixed.cppで定義)
+ */
+bool fixed_cascade_kernels(const unsigned int, const unsigned int, CascadeKernels&);
+
+#endif /* CASCADE_KERNEL_HPP_ */
@@ -0,0 +1,527 @@
+/*
+ * cma_es.cpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ */
+
+#include "cma_es.hpp"
+
+#include <algorithm>
+#include <limits>
+
+using namespace std;
+
+namespace
+{
+	constexpr unsigned int block_size = 32;	// 行列積のブロックの一辺
+	constexpr double max_condition = 1.0e14;	// 共分散行列の条件数の上限
+
+	/* # 行列積(ブロック化)
+	 *   C(m x n) = A(m x k) B(n x k)^T
+	 *   行列は全て行優先で，最内ループはAとBの行の連続した内積になる
+	 */
+	void multiply_nt(const double* A, const double* B, double* C,
+		const unsigned int m, const unsigned int n, const unsigned int k)
+	{
+		fill(C, C + (size_t)m*n, 0.0);
+		for (unsigned int ib = 0; ib < m; ib += block_size)
+		{
+			const unsigned int ie = min(m, ib + block_size);
+			for (unsigned int jb = 0; jb < n; jb += block_size)
+			{
+				const unsigned int je = min(n, jb + block_size);
+				for (unsigned int lb = 0; lb < k; lb += block_size)
+				{
+					const unsigned int le = min(k, lb + block_size);
+					for (unsigned int i = ib; i < ie; ++i)
+					{
+						const double* a = A + (size_t)i*k;
+						for (unsigned int j = jb; j < je; ++j)
+						{
+							const double* b = B + (size_t)j*k;
+							double sum = 0.0;
+							for (unsigned int l = lb; l < le; ++l)
+							{
+								sum += a[l]*b[l];
+							}
+							C[(size_t)i*n + j] += sum;
+						}
+					}
+				}
+			}
+		}
+	}
+
+	/* # 対称行列の更新(ブロック化)
+	 *   C(n x n) = alpha C + R^T R，R(r x n)は行優先
+	 *   下三角だけをブロックごとに更新し，最後に上三角へ写す
+	 */
+	void update_symmetric(double* C, const double alpha, const double* R,
+		const unsigned int r, const unsigned int n)
+	{
+		for (unsigned int i = 0; i < n; ++i)
+		{
+			for (unsigned int j = 0; j <= i; ++j)
+			{
+				C[(size_t)i*n + j] *= alpha;
+			}
+		}
+		for (unsigned int ib = 0; ib < n; ib += block_size)
+		{
+			const unsigned int ie = min(n, ib + block_size);
+			for (unsigned int jb = 0; jb <= ib; jb += block_size)
+			{
+				for (unsigned int lb = 0; lb < r; lb += block_size)
+				{
+					const unsigned int le = min(r, lb + block_size);
+					for (unsigned int i = ib; i < ie; ++i)
+					{
+						double* c = C + (size_t)i*n;
+						const unsigned int je = min(i + 1, jb + block_size);
+						for (unsigned int l = lb; l < le; ++l)
+						{
+							const double* row = R + (size_t)l*n;
+							const double ri = row[i];
+							for (unsigned int j = jb; j < je; ++j)
+							{
+								c[j] += ri*row[j];
+							}
+						}
+					}
+				}
+			}
+		}
+		for (unsigned int i = 0; i < n; ++i)
+		{
+			for (unsigned int j = i + 1; j < n; ++j)
+			{
+				C[(size_t)i*n + j] = C[(size_t)j*n + i];
+			}
+		}
+	}
+
+	/* # 固有値分解(巡回Jacobi法)
+	 *   対称行列A(n x n)を A = V diag(eig) V^T に分解する
+	 *   Aは破壊され，Vの列が固有ベクトルになる
+	 */
+	void eigen_symmetric(double* A, double* V, double* eig, const unsigned int n)
+	{
+		fill(V, V + (size_t)n*n, 0.0);
+		for (unsigned int i = 0; i < n; ++i)
+		{
+			V[(size_t)i*n + i] = 1.0;
+		}
+
+		for (unsigned int sweep = 0; sweep < 100; ++sweep)
+		{
+			double off = 0.0, diag = 0.0;
+			for (unsigned int p = 0; p < n; ++p)
+			{
+				diag += A[(size_t)p*n + p]*A[(size_t)p*n + p];
+				for (unsigned int q = p + 1; q < n; ++q)
+				{
+					off += A[(size_t)p*n + q]*A[(size_t)p*n + q];
+				}
+			}
+			if (off <= 1.0e-30*diag)
+			{
+				break;
+			}
+
+			for (unsigned int p = 0; p < n; ++p)
+			{
+				for (unsigned int q = p + 1; q < n; ++q)
+				{
+					const double apq = A[(size_t)p*n + q];
+					if (apq == 0.0)
+					{
+						continue;
+					}
+					const double theta = (A[(size_t)q*n + q] - A[(size_t)p*n + p])/(2.0*apq);
+					const double t = (theta >= 0.0 ? 1.0 : -1.0)/(abs(theta) + sqrt(theta*theta + 1.0));
+					const double c = 1.0/sqrt(t*t + 1.0);
+					const double s = t*c;
+
+					// A <- J^T A J，V <- V J
+					for (unsigned int k = 0; k < n; ++k)
+					{
+						const double akp = A[(size_t)k*n + p], akq = A[(size_t)k*n + q];
+						A[(size_t)k*n + p] = c*akp - s*akq;
+						A[(size_t)k*n + q] = s*akp + c*akq;
+					}
+					for (unsigned int k = 0; k < n; ++k)
+					{
+						const double apk = A[(size_t)p*n + k], aqk = A[(size_t)q*n + k];
+						A[(size_t)p*n + k] = c*apk - s*aqk;
+						A[(size_t)q*n + k] = s*apk + c*aqk;
+					}
+					for (unsigned int k = 0; k < n; ++k)
+					{
+						const double vkp = V[(size_t)k*n + p], vkq = V[(size_t)k*n + q];
+						V[(size_t)k*n + p] = c*vkp - s*vkq;
+						V[(size_t)k*n + q] = s*vkp + c*vkq;
+					}
+				}
+			}
+		}
+
+		for (unsigned int i = 0; i < n; ++i)
+		{
+			eig[i] = A[(size_t)i*n + i];
+		}
+	}
+}
+
+/* # CMA-ES
+ *   コンストラクタ
+ *
+ * # 引数
+ * FilterParam& fparam : 最適化するフィルタのパラメータ
+ * CMAESParam param : CMA-ESのパラメータ
+ * ThreadPool& pool : 評価に使うスレッドプール(省略時はプロセス共有のプール)
+ */
+CMAES::CMAES
+(const FilterParam& fparam, const CMAESParam& param, ThreadPool& pool)
+:fparam(fparam), param(param), pool(pool)
+{}
+
+/* # CMA-ES
+ *   既定の1世代の標本数 4 + floor(3 ln n)(lambdaが指定されていればその値，最小4)
+ */
+unsigned int CMAES::default_lambda() const
+{
+	if (param.lambda > 0)
+	{
+		return max(4u, param.lambda);
+	}
+	return 4 + (unsigned int)floor(3.0*log((double)fparam.opt_order()));
+}
+
+/* # CMA-ES
+ *   最初の実行の分布の平均を指定する(既存の設計の改良などに使う)
+ *   再始動後の実行の平均は乱数で生成する
+ */
+void CMAES::set_start(const vector<double>& coef)
+{
+	if (coef.size() != fparam.opt_order())
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, coef.size(), fparam.opt_order());
+		exit(EXIT_FAILURE);
+	}
+	start = coef;
+}
+
+vector<double> CMAES::init_mean(mt19937& mt) const
+{
+	return param.stable_init ? fparam.init_stable_coef(param.init_a0, param.init_a, mt) :
+		fparam.init_coef(param.init_a0, param.init_a, param.init_b, mt);
+}
+
+/* # CMA-ES
+ *   平均mean，標本数lambda，ステップ幅sigmaで1回の実行を行う
+ *   resultの最良値・評価回数・世代数・履歴を実行の間更新する
+ *
+ * # 返り値
+ * StopReason stop : Target, Generation, Evaluationは最適化全体の終了，
+ *                   Stagnationはこの実行の収束・退化(再始動の対象)
+ */
+StopReason CMAES::run_once
+(vector<double> mean, const unsigned int lambda, const double sigma0, mt19937& mt, OptimizeResult& result)
+{
+	const unsigned int n = fparam.opt_order();
+	const unsigned int mu = lambda/2;
+
+	// 利得a0は符号を固定し，log|a0|を探索する(X = mean + sigma Yの先頭列をexpで戻して評価する)
+	const double gain_sign = mean[0] < 0.0 ? -1.0 : 1.0;
+	mean[0] = log(max(abs(mean[0]), numeric_limits<double>::min()));
+
+	// 重みと学習率
+	vector<double> weight(mu);
+	double wsum = 0.0;
+	for (unsigned int i = 0; i < mu; ++i)
+	{
+		weight[i] = log(mu + 0.5) - log(i + 1.0);
+		wsum += weight[i];
+	}
+	double w2sum = 0.0;
+	for (auto& w : weight)
+	{
+		w /= wsum;
+		w2sum += w*w;
+	}
+	const double mueff = 1.0/w2sum;
+	const double cs = (mueff + 2.0)/(n + mueff + 5.0);
+	const double ds = 1.0 + 2.0*max(0.0, sqrt((mueff - 1.0)/(n + 1.0)) - 1.0) + cs;
+	const double cc = (4.0 + mueff/n)/(n + 4.0 + 2.0*mueff/n);
+	const double c1 = 2.0/((n + 1.3)*(n + 1.3) + mueff);
+	const double cmu = min(1.0 - c1, 2.0*(mueff - 2.0 + 1.0/mueff)/((n + 2.0)*(n + 2.0) + mueff));
+	const double chin = sqrt((double)n)*(1.0 - 1.0/(4.0*n) + 1.0/(21.0*n*n));
+	const unsigned int eigen_gap = max(1u, (unsigned int)(1.0/((c1 + cmu)*n*10.0)));
+	const unsigned int nrecent = 10 + (unsigned int)ceil(30.0*n/lambda);
+	const unsigned int nstagnation = param.stagnation > 0 ? param.stagnation :
+		120 + (unsigned int)ceil(30.0*n/lambda);
+
+	// 分布の状態(C = B diag(D)^2 B^T)
+	vector<double> C((size_t)n*n, 0.0), B((size_t)n*n, 0.0), BD((size_t)n*n, 0.0);
+	vector<double> work((size_t)n*n), eig(n), D(n, 1.0);
+	for (unsigned int i = 0; i < n; ++i)
+	{
+		C[(size_t)i*n + i] = B[(size_t)i*n + i] = BD[(size_t)i*n + i] = 1.0;
+	}
+	vector<double> pc(n, 0.0), ps(n, 0.0), yw(n), zw(n), bz(n);
+
+	// 1世代分の標本と更新用の行列(開始時に1度だけ確保する)
+	vector<double> Z((size_t)lambda*n), Y((size_t)lambda*n), X((size_t)lambda*n);
+	vector<double> R((size_t)(mu + 1)*n);
+	vector<double> value(lambda);
+	vector<unsigned int> index(lambda);
+	vector<double> recent;
+	recent.reserve(nrecent);
+
+	normal_distribution<> gauss(0.0, 1.0);
+	double sigma = sigma0;
+	vector<double> history;
+	for (unsigned int gen = 0; ; ++gen)
+	{
+		if (result.nevaluation + lambda > param.max_evaluation)
+		{
+			return StopReason::Evaluation;
+		}
+		if (result.generation >= param.max_generation)
+		{
+			return StopReason::Generation;
+		}
+
+		// 標本の生成 X = mean + sigma Z (BD)^T
+		for (auto& z : Z)
+		{
+			z = gauss(mt);
+		}
+		multiply_nt(Z.data(), BD.data(), Y.data(), lambda, n, n);
+		for (unsigned int k = 0; k < lambda; ++k)
+		{
+			for (unsigned int j = 0; j < n; ++j)
+			{
+				X[(size_t)k*n + j] = mean[j] + sigma*Y[(size_t)k*n + j];
+			}
+			X[(size_t)k*n] = gain_sign*exp(X[(size_t)k*n]);
+		}
+
+		fparam.evaluate_batch_parallel(X.data(), lambda, value.data(), pool);
+		result.nevaluation += lambda;
+		++result.generation;
+
+		for (unsigned int k = 0; k < lambda; ++k)
+		{
+			index[k] = k;
+		}
+		sort(index.begin(), index.end(),
+			[&value](const unsigned int i, const unsigned int j){ return value[i] < value[j]; });
+
+		const double gen_best = value[index[0]];
+		if (gen_best < result.value)
+		{
+			result.value = gen_best;
+			result.coef.assign(X.begin() + (size_t)index[0]*n, X.begin() + (size_t)(index[0] + 1)*n);
+		}
+		result.history.push_back(result.value);
+		if (result.value <= param.target)
+		{
+			return StopReason::Target;
+		}
+
+		// 平均と進化パスの更新
+		fill(yw.begin(), yw.end(), 0.0);
+		fill(zw.begin(), zw.end(), 0.0);
+		for (unsigned int i = 0; i < mu; ++i)
+		{
+			const double* y = &Y[(size_t)index[i]*n];
+			const double* z = &Z[(size_t)index[i]*n];
+			for (unsigned int j = 0; j < n; ++j)
+			{
+				yw[j] += weight[i]*y[j];
+				zw[j] += weight[i]*z[j];
+			}
+		}
+		for (unsigned int j = 0; j < n; ++j)
+		{
+			mean[j] += sigma*yw[j];
+		}
+
+		// C^(-1/2) yw = B zw
+		multiply_nt(B.data(), zw.data(), bz.data(), n, 1, n);
+		const double ps_rate = sqrt(cs*(2.0 - cs)*mueff);
+		double ps_norm = 0.0;
+		for (unsigned int j = 0; j < n; ++j)
+		{
+			ps[j] = (1.0 - cs)*ps[j] + ps_rate*bz[j];
+			ps_norm += ps[j]*ps[j];
+		}
+		ps_norm = sqrt(ps_norm);
+		const bool hsig = ps_norm/sqrt(1.0 - pow(1.0 - cs, 2.0*(gen + 1)))/chin < 1.4 + 2.0/(n + 1.0);
+		const double pc_rate = hsig ? sqrt(cc*(2.0 - cc)*mueff) : 0.0;
+		for (unsigned int j = 0; j < n; ++j)
+		{
+			pc[j] = (1.0 - cc)*pc[j] + pc_rate*yw[j];
+		}
+
+		// 共分散行列の更新 C = alpha C + R^T R(Rの行はランクμ更新の標本とランク1更新の進化パス)
+		for (unsigned int i = 0; i < mu; ++i)
+		{
+			const double scale = sqrt(cmu*weight[i]);
+			const double* y = &Y[(size_t)index[i]*n];
+			for (unsigned int j = 0; j < n; ++j)
+			{
+				R[(size_t)i*n + j] = scale*y[j];
+			}
+		}
+		for (unsigned int j = 0; j < n; ++j)
+		{
+			R[(size_t)mu*n + j] = sqrt(c1)*pc[j];
+		}
+		const double alpha = 1.0 - c1 - cmu + (hsig ? 0.0 : c1*cc*(2.0 - cc));
+		update_symmetric(C.data(), alpha, R.data(), mu + 1, n);
+
+		sigma *= exp(cs/ds*(ps_norm/chin - 1.0));
+
+		// 固有値分解(eigen_gap世代おき)
+		if ((gen + 1) % eigen_gap == 0)
+		{
+			copy(C.begin(), C.end(), work.begin());
+			eigen_symmetric(work.data(), B.data(), eig.data(), n);
+			const double eig_max = *max_element(eig.begin(), eig.end());
+			const double eig_min = *min_element(eig.begin(), eig.end());
+			if (!(eig_min > 0.0) || eig_max > max_condition*eig_min)
+			{
+				return StopReason::Stagnation;
+			}
+			for (unsigned int i = 0; i < n; ++i)
+			{
+				D[i] = sqrt(eig[i]);
+			}
+			for (unsigned int i = 0; i < n; ++i)
+			{
+				for (unsigned int j = 0; j < n; ++j)
+				{
+					BD[(size_t)i*n + j] = B[(size_t)i*n + j]*D[j];
+				}
+			}
+		}
+
+		// この実行の終了判定
+		if (!isfinite(sigma) || !isfinite(gen_best))
+		{
+			return StopReason::Stagnation;
+		}
+		if (recent.size() == nrecent)
+		{
+			recent.erase(recent.begin());
+		}
+		recent.push_back(gen_best);
+		if (recent.size() == nrecent &&
+			*max_element(recent.begin(), recent.end()) - *min_element(recent.begin(), recent.end()) < param.tol_fun)
+		{
+			return StopReason::Stagnation;
+		}
+
+		bool small = true;
+		for (unsigned int j = 0; j < n && small; ++j)
+		{
+			small = sigma*sqrt(C[(size_t)j*n + j]) < param.tol_x && sigma*abs(pc[j]) < param.tol_x;
+		}
+		if (small)
+		{
+			return StopReason::Stagnation;
+		}
+
+		// 直近nstagnation世代のうち，後ろ2割の最良値の中央値が前2割の中央値より改善していなければ停滞
+		history.push_back(gen_best);
+		if (history.size() >= nstagnation)
+		{
+			const unsigned int part = max(1u, nstagnation/5);
+			auto end = history.end(), begin = end - nstagnation;
+			vector<double> first(begin, begin + part), last(end - part, end);
+			nth_element(first.begin(), first.begin() + part/2, first.end());
+			nth_element(last.begin(), last.begin() + part/2, last.end());
+			if (last[part/2] >= first[part/2])
+			{
+				return StopReason::Stagnation;
+			}
+		}
+	}
+}
+
+/* # CMA-ES
+ *   最適化を実行する
+ *   1回の実行が収束・退化すると，restartの方式に従い標本数とステップ幅を変えて
+ *   新しい平均から再始動する
+ *   目標値への到達，世代数・評価回数の上限，再始動の上限のいずれかで終了する
+ *
+ * # 返り値
+ * OptimizeResult result : 最良の係数列・目的関数値と世代ごとの最良値
+ *                         (history[0]は最初の実行の初期平均の値)
+ */
+OptimizeResult CMAES::run()
+{
+	mt19937 mt(param.seed);
+	uniform_real_distribution<> unit(0.0, 1.0);
+	const unsigned int lambda_default = default_lambda();
+
+	OptimizeResult result;
+	vector<double> mean = start.empty() ? init_mean(mt) : start;
+	result.value = fparam.evaluate(mean);
+	result.coef = mean;
+	result.nevaluation = 1;
+	result.history.push_back(result.value);
+	if (result.value <= param.target)
+	{
+		result.stop = StopReason::Target;
+		return result;
+	}
+
+	// BIPOPの大集団・小集団それぞれで使った評価回数
+	unsigned long large_budget = 0, small_budget = 0;
+	unsigned int nlarge = 0;
+	for (unsigned int restart = 0; ; ++restart)
+	{
+		unsigned int lambda = lambda_default;
+		double sigma = param.sigma;
+		bool large = true;
+		if (restart > 0)
+		{
+			mean = init_mean(mt);
+			if (param.restart == CMARestart::IPOP)
+			{
+				lambda = lambda_default << restart;
+			}
+			else if (small_budget < large_budget)
+			{
+				const double u = unit(mt);
+				const double lambda_large = (double)(lambda_default << nlarge);
+				lambda = max(lambda_default, (unsigned int)floor(lambda_default*pow(0.5*lambda_large/lambda_default, u*u)));
+				sigma = param.sigma*pow(10.0, -2.0*unit(mt));
+				large = false;
+			}
+			else
+			{
+				++nlarge;
+				lambda = lambda_default << nlarge;
+			}
+		}
+
+		const unsigned long before = result.nevaluation;
+		result.stop = run_once(mean, lambda, sigma, mt, result);
+		(large ? large_budget : small_budget) += result.nevaluation - before;
+
+		if (result.stop != StopReason::Stagnation ||
+			param.restart == CMARestart::None || restart >= param.max_restart)
+		{
+			break;
+		}
+	}
+
+	return result;
+}
@@ -0,0 +1,106 @@
+/*
+ * cma_es.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ *
+ * This cord is written by UTF-8
+ */
+
+#ifndef CMA_ES_HPP_
+#define CMA_ES_HPP_
+
+#include "filter_param.hpp"
+#include "optimizer.hpp"
+
+/* CMA-ESの再始動の方式を示す列挙体
+ *   None : 再始動しない
+ *   IPOP : 収束するたびに個体数を2倍にして再始動する
+ *   BIPOP : 個体数を2倍にする大集団の実行と，個体数・ステップ幅を乱数で小さくした
+ *           小集団の実行を，それぞれの評価回数の合計が釣り合うように交互に行う
+ */
+enum class CMARestart
+{
+	None,
+	IPOP,
+	BIPOP
+};
+
+/* CMA-ESのパラメータ
+ *   lambda : 1世代の標本数(0なら4 + floor(3 ln n)，nは係数の数)
+ *   sigma : 初期ステップ幅
+ *   restart : 再始動の方式
+ *   max_restart : 再始動の回数の上限
+ *   max_evaluation : 評価回数の上限(全実行の合計)
+ *   max_generation : 世代数の上限(全実行の合計)
+ *   target : 目的関数値の目標値(これ以下で終了)
+ *   stagnation : 直近stagnation世代で各世代の最良値の中央値が改善しなければ再始動
+ *                (0なら120 + 30n/lambda)
+ *   tol_fun : 直近の世代の最良値の幅がこれ未満なら再始動
+ *   tol_x : ステップ幅 x 標準偏差の最大値がこれ未満なら再始動
+ *   seed : 乱数のシード値
+ *   init_a0, init_a, init_b : 分布の初期平均を生成する範囲(init_coefの引数と同じ)
+ *   stable_init : trueならinit_stable_coef(init_a0, init_a)で初期平均を生成する
+ */
+struct CMAESParam
+{
+	unsigned int lambda;
+	double sigma;
+	CMARestart restart;
+	unsigned int max_restart;
+	unsigned long max_evaluation;
+	unsigned int max_generation;
+	double target;
+	unsigned int stagnation;
+	double tol_fun;
+	double tol_x;
+	unsigned long seed;
+	double init_a0;
+	double init_a;
+	double init_b;
+	bool stable_init;
+
+	CMAESParam()
+	: lambda(0), sigma(0.5), restart(CMARestart::BIPOP), max_restart(9),
+	  max_evaluation(100000), max_generation(100000), target(0.0), stagnation(0),
+	  tol_fun(1.0e-12), tol_x(1.0e-12), seed(0),
+	  init_a0(0.5), init_a(3.0), init_b(3.0), stable_init(true)
+	{}
+};
+
+/* フィルタ係数のCMA-ES(共分散行列適応進化戦略)による最適化器
+ *   1世代のλ個の標本を1つの行列に生成し，FilterParam::evaluate_batch_parallelで
+ *   まとめて評価する
+ *   標本の生成(Z (BD)^T)と共分散行列のランク1・ランクμ更新(R^T R)は
+ *   ブロック化した行列積で行い，固有値分解は数世代おきに行う
+ *   利得a0は他の係数と桁が大きく異なるため，符号を初期平均に固定して対数で探索する
+ *   係数間の相関が強い高次のフィルタで，差分進化より少ない評価回数で収束する
+ */
+class CMAES
+{
+private:
+	const FilterParam& fparam;
+	CMAESParam param;
+	ThreadPool& pool;
+	vector<double> start;	// 最初の実行の初期平均(空なら乱数で生成)
+
+	vector<double> init_mean(mt19937&) const;
+	StopReason run_once(vector<double>, const unsigned int, const double, mt19937&, OptimizeResult&);
+
+public:
+	CMAES(const FilterParam&, const CMAESParam& param = CMAESParam(),
+		ThreadPool& pool = ThreadPool::global());
+
+	// get function
+
+	const CMAESParam& parameter() const
+	{ return param; }
+	unsigned int default_lambda() const;
+
+	// normal function
+
+	void set_start(const vector<double>&);
+	OptimizeResult run();
+};
+
+#endif /* CMA_ES_HPP_ */
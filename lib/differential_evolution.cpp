@@ -0,0 +1,190 @@
+/*
+ * differential_evolution.cpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ */
+
+#include "differential_evolution.hpp"
+
+using namespace std;
+
+/* # 差分進化
+ *   コンストラクタ
+ *
+ * # 引数
+ * FilterParam& fparam : 最適化するフィルタのパラメータ
+ * DEParam param : 差分進化のパラメータ
+ * ThreadPool& pool : 評価に使うスレッドプール(省略時はプロセス共有のプール)
+ */
+DifferentialEvolution::DifferentialEvolution
+(const FilterParam& fparam, const DEParam& param, ThreadPool& pool)
+:fparam(fparam), param(param), pool(pool)
+{}
+
+/* # 差分進化
+ *   初期集団に入れる係数列を追加する(既存の設計の改良などに使う)
+ *   個体数を超えた分は使わない
+ */
+void DifferentialEvolution::add_seed(const vector<double>& coef)
+{
+	if (coef.size() != fparam.opt_order())
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, coef.size(), fparam.opt_order());
+		exit(EXIT_FAILURE);
+	}
+	seeds.push_back(coef);
+}
+
+/* # 差分進化
+ *   最適化を実行する
+ *   目標値への到達，世代数の上限，最良値の停滞のいずれかで終了する
+ *
+ * # 返り値
+ * OptimizeResult result : 最良の係数列・目的関数値と世代ごとの最良値
+ */
+OptimizeResult DifferentialEvolution::run()
+{
+	const unsigned int np = max(4u, param.population);
+	const unsigned int dim = fparam.opt_order();
+	mt19937 mt(param.seed);
+	uniform_real_distribution<> unit(0.0, 1.0);
+	uniform_int_distribution<unsigned int> pick(0, np - 1);
+	uniform_int_distribution<unsigned int> pick_dim(0, dim - 1);
+
+	vector<double> population(np*dim);
+	vector<double> trial(np*dim);
+	vector<double> value(np);
+	vector<double> trial_value(np);
+
+	// stable_paramなら個体は安定化変数
+	auto evaluate = [&](const double* xs, double* values)
+	{
+		if (param.stable_param)
+		{
+			fparam.evaluate_stable_batch_parallel(xs, np, values, pool);
+		}
+		else
+		{
+			fparam.evaluate_batch_parallel(xs, np, values, pool);
+		}
+	};
+
+	// 初期集団(シード個体の後ろを乱数で埋める)
+	for (unsigned int k = 0; k < np; ++k)
+	{
+		vector<double> coef = k < seeds.size() ? seeds[k] :
+			param.stable_init ? fparam.init_stable_coef(param.init_a0, param.init_a, mt) :
+			fparam.init_coef(param.init_a0, param.init_a, param.init_b, mt);
+		if (param.stable_param)
+		{
+			fparam.coef_to_stable(coef.data(), &population[(size_t)k*dim]);
+		}
+		else
+		{
+			copy(coef.begin(), coef.end(), population.begin() + (size_t)k*dim);
+		}
+	}
+	evaluate(population.data(), value.data());
+
+	OptimizeResult result;
+	result.nevaluation = np;
+	unsigned int best = min_element(value.begin(), value.end()) - value.begin();
+	result.history.push_back(value[best]);
+
+	unsigned int stagnant = 0;
+	result.stop = StopReason::Generation;
+	while (true)
+	{
+		if (value[best] <= param.target)
+		{
+			result.stop = StopReason::Target;
+			break;
+		}
+		if (result.generation >= param.max_generation)
+		{
+			result.stop = StopReason::Generation;
+			break;
+		}
+		if (param.stagnation > 0 && stagnant >= param.stagnation)
+		{
+			result.stop = StopReason::Stagnation;
+			break;
+		}
+
+		// 試行ベクトルの生成(変異と二項交叉)
+		const double* xbest = &population[(size_t)best*dim];
+		for (unsigned int i = 0; i < np; ++i)
+		{
+			unsigned int r0, r1, r2;
+			do { r0 = pick(mt); } while (r0 == i);
+			do { r1 = pick(mt); } while (r1 == i || r1 == r0);
+			do { r2 = pick(mt); } while (r2 == i || r2 == r0 || r2 == r1);
+
+			const double* xi = &population[(size_t)i*dim];
+			const double* x0 = &population[(size_t)r0*dim];
+			const double* x1 = &population[(size_t)r1*dim];
+			const double* x2 = &population[(size_t)r2*dim];
+			double* u = &trial[(size_t)i*dim];
+			const unsigned int jrand = pick_dim(mt);
+			for (unsigned int j = 0; j < dim; ++j)
+			{
+				if (j == jrand || unit(mt) < param.crossover)
+				{
+					if (param.strategy == DEStrategy::Rand1Bin)
+					{
+						u[j] = x0[j] + param.scale*(x1[j] - x2[j]);
+					}
+					else
+					{
+						u[j] = xi[j] + param.scale*(xbest[j] - xi[j]) + param.scale*(x1[j] - x2[j]);
+					}
+				}
+				else
+				{
+					u[j] = xi[j];
+				}
+			}
+		}
+
+		evaluate(trial.data(), trial_value.data());
+		result.nevaluation += np;
+
+		// 選択
+		const double previous = value[best];
+		for (unsigned int i = 0; i < np; ++i)
+		{
+			if (trial_value[i] <= value[i])
+			{
+				value[i] = trial_value[i];
+				copy(trial.begin() + (size_t)i*dim, trial.begin() + (size_t)(i + 1)*dim,
+					population.begin() + (size_t)i*dim);
+				if (value[i] < value[best])
+				{
+					best = i;
+				}
+			}
+		}
+
+		++result.generation;
+		result.history.push_back(value[best]);
+		if (previous - value[best] > param.stagnation_tol*abs(previous))
+		{
+			stagnant = 0;
+		}
+		else
+		{
+			++stagnant;
+		}
+	}
+
+	result.coef.assign(population.begin() + (size_t)best*dim, population.begin() + (size_t)(best + 1)*dim);
+	if (param.stable_param)
+	{
+		result.coef = fparam.stable_to_coef(result.coef);
+	}
+	result.value = value[best];
+	return result;
+}
@@ -0,0 +1,97 @@
+/*
+ * differential_evolution.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ *
+ * This cord is written by UTF-8
+ */
+
+#ifndef DIFFERENTIAL_EVOLUTION_HPP_
+#define DIFFERENTIAL_EVOLUTION_HPP_
+
+#include "filter_param.hpp"
+#include "optimizer.hpp"
+
+/* 差分進化の変異戦略を示す列挙体
+ *   Rand1Bin : v = x_r0 + F (x_r1 - x_r2)，二項交叉
+ *   CurrentToBest1Bin : v = x_i + F (x_best - x_i) + F (x_r1 - x_r2)，二項交叉
+ */
+enum class DEStrategy
+{
+	Rand1Bin,
+	CurrentToBest1Bin
+};
+
+/* 差分進化のパラメータ
+ *   strategy : 変異戦略
+ *   population : 個体数(4未満の場合は4とする)
+ *   scale : 差分ベクトルの倍率F
+ *   crossover : 交叉率CR
+ *   max_generation : 世代数の上限
+ *   target : 目的関数値の目標値(これ以下で終了)
+ *   stagnation : 最良値がstagnation世代続けて改善しなければ終了(0で無効)
+ *   stagnation_tol : 改善とみなす最良値の相対減少量
+ *   seed : 乱数のシード値(同じシード値・同じシード個体なら同じ結果になる)
+ *   init_a0, init_a, init_b : 初期集団の係数の範囲(init_coefの引数と同じ)
+ *   stable_init : trueならinit_stable_coef(init_a0, init_a)で初期集団を生成する
+ *   stable_param : trueなら安定化変数(FilterParam::stable_to_coef)の空間で探索する
+ *                  全候補が安定になり，安定性のペナルティで評価を無駄にしない
+ *                  初期集団・シード個体は係数列で与え，coef_to_stableで写す
+ *                  結果の係数列は係数列の空間に戻して返す
+ */
+struct DEParam
+{
+	DEStrategy strategy;
+	unsigned int population;
+	double scale;
+	double crossover;
+	unsigned int max_generation;
+	double target;
+	unsigned int stagnation;
+	double stagnation_tol;
+	unsigned long seed;
+	double init_a0;
+	double init_a;
+	double init_b;
+	bool stable_init;
+	bool stable_param;
+
+	DEParam()
+	: strategy(DEStrategy::Rand1Bin), population(50), scale(0.5), crossover(0.9),
+	  max_generation(1000), target(0.0), stagnation(0), stagnation_tol(1.0e-9), seed(0),
+	  init_a0(0.5), init_a(3.0), init_b(3.0), stable_init(true),
+	  stable_param(false)
+	{}
+};
+
+/* フィルタ係数の差分進化による最適化器
+ *   世代ごとに全個体の試行ベクトルを1つの行列に作り，
+ *   FilterParam::evaluate_batch_parallelでまとめて並列に評価する
+ *   集団・試行ベクトル・目的関数値の領域は開始時に1度だけ確保する
+ *   試行ベクトルの生成は1つの乱数生成器で順に行うため，スレッド数によらず結果は同じ
+ */
+class DifferentialEvolution
+{
+private:
+	const FilterParam& fparam;
+	DEParam param;
+	ThreadPool& pool;
+	vector<vector<double>> seeds;	// 初期集団の先頭に入れる係数列
+
+public:
+	DifferentialEvolution(const FilterParam&, const DEParam& param = DEParam(),
+		ThreadPool& pool = ThreadPool::global());
+
+	// get function
+
+	const DEParam& parameter() const
+	{ return param; }
+
+	// normal function
+
+	void add_seed(const vector<double>&);
+	OptimizeResult run();
+};
+
+#endif /* DIFFERENTIAL_EVOLUTION_HPP_ */
@@ -0,0 +1,184 @@
+/*
+ * fft.cpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ */
+
+#define _USE_MATH_DEFINES
+
+#include "fft.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cmath>
+
+using namespace std;
+
+bool is_power_of_two(const unsigned int n)
+{
+	return n != 0 && (n & (n - 1)) == 0;
+}
+
+/* # 高速フーリエ変換
+ *   段ごとの回転因子の表
+ *   長さlenの段の回転因子e^-j2πk/len (k = 0, 1,..., len/2 - 1)を
+ *   table[len/2 - 1]から連続に並べ，バタフライが表を連続に読むようにする
+ *   長さnまでの表は長さ2nの表の先頭と同じため，スレッドごとに最大長の表を保持して再利用する
+ */
+static const complex<double>* twiddle_table(const unsigned int n)
+{
+	thread_local vector<complex<double>> table;
+	if (table.size() < n - 1)
+	{
+		table.resize(n - 1);
+
+		// 最長の段だけ三角関数で計算し(1/4周期分から対称性で展開)，短い段は間引いて写す
+		complex<double>* last = table.data() + n/2 - 1;
+		const unsigned int quarter = n/4;
+		for (unsigned int k = 0; k < quarter || (n == 2 && k == 0); ++k)
+		{
+			last[k] = polar(1.0, -2.0*M_PI*k/n);
+		}
+		for (unsigned int k = quarter; k < n/2 && quarter > 0; ++k)
+		{
+			// e^-j2π(k)/n = -j e^-j2π(k - n/4)/n
+			const complex<double> w = last[k - quarter];
+			last[k] = complex<double>(w.imag(), -w.real());
+		}
+		for (unsigned int len = n/2; len >= 2; len >>= 1)
+		{
+			complex<double>* stage = table.data() + len/2 - 1;
+			const unsigned int step = n/len;
+			for (unsigned int k = 0; k < len/2; ++k)
+			{
+				stage[k] = last[k*step];
+			}
+		}
+	}
+	return table.data();
+}
+
+/* # 高速フーリエ変換
+ *   変換の本体(twiddle_tableの段ごとの表を使う)
+ *   complex<double>の乗算はNaN処理の呼び出し(__muldc3)を伴うため，実数演算で書く
+ */
+static void fft_core(complex<double>* data, const unsigned int n, const complex<double>* twiddle, const bool inverse)
+{
+	// ビット反転の並べ替え
+	for (unsigned int i = 1, j = 0; i < n; ++i)
+	{
+		unsigned int bit = n >> 1;
+		for (; j & bit; bit >>= 1)
+		{
+			j ^= bit;
+		}
+		j ^= bit;
+		if (i < j)
+		{
+			swap(data[i], data[j]);
+		}
+	}
+
+	double* d = reinterpret_cast<double*>(data);
+	const double sign = inverse ? -1.0 : 1.0;
+	for (unsigned int len = 2; len <= n; len <<= 1)
+	{
+		const unsigned int half = len/2;
+		const double* w = reinterpret_cast<const double*>(twiddle + half - 1);
+		for (unsigned int i = 0; i < n; i += len)
+		{
+			double* u = d + 2*i;
+			double* v = d + 2*(i + half);
+			for (unsigned int k = 0; k < half; ++k)
+			{
+				const double wr = w[2*k];
+				const double wi = sign*w[2*k + 1];
+				const double vr = v[2*k]*wr - v[2*k + 1]*wi;
+				const double vi = v[2*k]*wi + v[2*k + 1]*wr;
+				v[2*k] = u[2*k] - vr;
+				v[2*k + 1] = u[2*k + 1] - vi;
+				u[2*k] += vr;
+				u[2*k + 1] += vi;
+			}
+		}
+	}
+}
+
+void fft(vector<complex<double>>& data, const bool inverse)
+{
+	const unsigned int n = data.size();
+	if (!is_power_of_two(n))
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Length of FFT must be a power of two.(length : %u)\n",
+			__FILE__, __LINE__, n);
+		exit(EXIT_FAILURE);
+	}
+	if (n == 1)
+	{
+		return;
+	}
+
+	fft_core(data.data(), n, twiddle_table(n), inverse);
+
+	if (inverse)
+	{
+		for (auto& x : data)
+		{
+			x /= (double)n;
+		}
+	}
+}
+
+void rfft(const vector<double>& data, vector<complex<double>>& spectrum)
+{
+	const unsigned int n = data.size();
+	if (n < 2 || !is_power_of_two(n))
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Length of real FFT must be a power of two and at least 2.(length : %u)\n",
+			__FILE__, __LINE__, n);
+		exit(EXIT_FAILURE);
+	}
+
+	// 偶数番目を実部，奇数番目を虚部とした長さN/2の複素数列
+	const unsigned int h = n/2;
+	const complex<double>* table = twiddle_table(n);
+	const complex<double>* twiddle = table + h - 1;	// e^-j2πk/N (k = 0, 1,..., N/2 - 1)
+	spectrum.resize(h + 1);
+	for (unsigned int i = 0; i < h; ++i)
+	{
+		spectrum[i] = complex<double>(data[2*i], data[2*i + 1]);
+	}
+	if (h > 1)
+	{
+		fft_core(spectrum.data(), h, table, false);
+	}
+
+	// X[k] = E[k] + e^-j2πk/N O[k]
+	//   E[k] = (Z[k] + conj(Z[N/2 - k])) / 2, O[k] = (Z[k] - conj(Z[N/2 - k])) / 2j
+	//   kとN/2 - kを組にしてその場で計算する
+	const complex<double> z0 = spectrum[0];
+	spectrum[0] = complex<double>(z0.real() + z0.imag(), 0.0);
+	spectrum[h] = complex<double>(z0.real() - z0.imag(), 0.0);
+	for (unsigned int k = 1; k <= h/2; ++k)
+	{
+		const unsigned int l = h - k;
+		const complex<double> zk = spectrum[k];
+		const complex<double> zl = spectrum[l];
+
+		const double er = 0.5*(zk.real() + zl.real());
+		const double ei = 0.5*(zk.imag() - zl.imag());
+		const double or_ = 0.5*(zk.imag() + zl.imag());
+		const double oi = -0.5*(zk.real() - zl.real());
+
+		// X[k] = E + W^k O, X[N/2 - k] = conj(E) - conj(W^k O)   (W^(N/2 - k) = -conj(W^k))
+		const double wr = twiddle[k].real();
+		const double wi = twiddle[k].imag();
+		const double tr = wr*or_ - wi*oi;
+		const double ti = wr*oi + wi*or_;
+		spectrum[k] = complex<double>(er + tr, ei + ti);
+		spectrum[l] = complex<double>(er - tr, ti - ei);
+	}
+}
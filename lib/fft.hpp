@@ -0,0 +1,44 @@
+/*
+ * fft.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ *
+ * This cord is written by UTF-8
+ */
+
+#ifndef FFT_HPP_
+#define FFT_HPP_
+
+#include <vector>
+#include <complex>
+
+using namespace std;
+
+/* 高速フーリエ変換(基数2，外部ライブラリ不使用)
+ *   データ長は2のべき乗であること。それ以外の場合、エラー終了。
+ *   変換の符号は X[k] = Σ x[n] e^-j2πkn/N (逆変換は1/Nを掛ける)
+ */
+
+bool is_power_of_two(const unsigned int);
+
+/* # 高速フーリエ変換
+ *   複素数列の変換をその場で行う(反復型Cooley-Tukey)
+ *
+ * # 引数
+ * vector<complex<double>>& data : 変換する数列(結果で上書き)
+ * bool inverse : trueの場合は逆変換
+ */
+void fft(vector<complex<double>>&, const bool inverse = false);
+
+/* # 高速フーリエ変換
+ *   実数列の変換
+ *   長さNの実数列を長さN/2の複素数列として変換し，スペクトルに展開する
+ *
+ * # 引数
+ * vector<double>& data : 変換する実数列(長さNは2以上の2のべき乗)
+ * vector<complex<double>>& spectrum : X[0]からX[N/2]までのN/2 + 1点の出力
+ */
+void rfft(const vector<double>&, vector<complex<double>>&);
+
+#endif /* FFT_HPP_ */
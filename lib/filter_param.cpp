@@ -6,9 +6,18 @@
  */
 
 #include "filter_param.hpp"
+#include "cascade_kernel.hpp"
+#include "fft.hpp"
 
 using namespace std;
 
+constexpr double stability_weight = 100;	//安定性のペナルティの重み
+constexpr double riple_weight = 100;		//振幅隆起のペナルティの重み
+constexpr double candidate_lane_overhead = 0.2;	//候補解方向の評価の割高分(EvalMode::Complex, use_candidate_lanes)
+constexpr double candidate_lane_overhead_mag = 0.05;	//候補解方向の評価の割高分(EvalMode::Magnitude, use_candidate_lanes)
+constexpr double band_setup_cost = 4.0;	//1候補・1帯域あたりの固定の処理量(1節のSIMD反復の回数換算, use_candidate_lanes)
+constexpr double stable_radius = 1.0 - 1.0e-6;	//安定化変数の写像(stable_to_coef)の極の半径の上限ρ
+
 FILE *fileopen(const string &filename, const char mode, const string &call_file, const int call_line)
 {
 	FILE *fp = fopen(filename.c_str(), &mode);
@@ -80,7 +89,9 @@ FilterParam::FilterParam
 :n_order(zero), m_order(pole), bands(vector<BandParam> {input_band}),
  nsplit_approx(input_nsplit_approx), nsplit_transition(input_nsplit_transition),
  group_delay(gd),
- threshold_riple(1.0)
+ threshold_riple(1.0), eval_mode(EvalMode::Complex), group_delay_weight(1.0),
+ batch_layout(BatchLayout::Frequency),
+ cascade_type(CascadeType::SE), fixed_order(false)
 {
 	// 帯域ごとの分割数算出
 	double approx_range = 0.0;
@@ -138,47 +149,34 @@ FilterParam::FilterParam
 
 	// generate complex sin wave(e^-jω)
 	// desire frequency response
-	csw.reserve(bands.size());
-	csw2.reserve(bands.size());
-	desire_res.reserve(bands.size());
-	for (unsigned int i = 0; i < bands.size(); ++i)
-	{
-		csw.emplace_back(gen_csw(bands.at(i), split.at(i)));
-		csw2.emplace_back(gen_csw2(bands.at(i), split.at(i)));
-		desire_res.emplace_back(gen_desire_res(bands.at(i), split.at(i), group_delay));
-	}
+	grid = gen_grid(bands, split, group_delay);
 
-	// decide using function
+	// decide cascade type
 	if ((n_order % 2) == 0)
 	{
 		if ((m_order % 2) == 0)
 		{
-			freq_res_func = &FilterParam::freq_res_se;
-			group_delay_func = &FilterParam::group_delay_se;
-			stability_func = &FilterParam::judge_stability_even;
+			cascade_type = CascadeType::SE;
 		}
 		else
 		{
-			freq_res_func = &FilterParam::freq_res_mo;
-			group_delay_func = &FilterParam::group_delay_mo;
-			stability_func = &FilterParam::judge_stability_odd;
+			cascade_type = CascadeType::MO;
 		}
 	}
 	else
 	{
 		if ((m_order % 2) == 0)
 		{
-			freq_res_func = &FilterParam::freq_res_no;
-			group_delay_func = &FilterParam::group_delay_no;
-			stability_func = &FilterParam::judge_stability_even;
+			cascade_type = CascadeType::NO;
 		}
 		else
 		{
-			freq_res_func = &FilterParam::freq_res_so;
-			group_delay_func = &FilterParam::group_delay_so;
-			stability_func = &FilterParam::judge_stability_odd;
+			cascade_type = CascadeType::SO;
 		}
 	}
+
+	// decide using kernel
+	set_fixed_order(true);
 }
 
 FilterParam::FilterParam
@@ -188,7 +186,9 @@ FilterParam::FilterParam
 :n_order(zero), m_order(pole), bands(input_bands),
  nsplit_approx(input_nsplit_approx), nsplit_transition(input_nsplit_transition),
  group_delay(gd),
- threshold_riple(1.0)
+ threshold_riple(1.0), eval_mode(EvalMode::Complex), group_delay_weight(1.0),
+ batch_layout(BatchLayout::Frequency),
+ cascade_type(CascadeType::SE), fixed_order(false)
 {
 	// 周波数帯域の整合性チェック
 	double band_left = 0.0;
@@ -275,47 +275,39 @@ FilterParam::FilterParam
 
 	// generate complex sin wave(e^-jω)
 	// desire frequency response
-	csw.reserve(bands.size());
-	csw2.reserve(bands.size());
-	desire_res.reserve(bands.size());
-	for (unsigned int i = 0; i < bands.size(); ++i)
-	{
-		csw.emplace_back(gen_csw(bands.at(i), split.at(i)));
-		csw2.emplace_back(gen_csw2(bands.at(i), split.at(i)));
-		desire_res.emplace_back(gen_desire_res(bands.at(i), split.at(i), group_delay));
-	}
+	grid = gen_grid(bands, split, group_delay);
 
-	// decide using function
+	// decide cascade type
 	if ((n_order % 2) == 0)
 	{
 		if ((m_order % 2) == 0)
 		{
-			freq_res_func = &FilterParam::freq_res_se;
-			group_delay_func = &FilterParam::group_delay_se;
-			stability_func = &FilterParam::judge_stability_even;
+			cascade_type = CascadeType::SE;
 		}
 		else
 		{
-			freq_res_func = &FilterParam::freq_res_mo;
-			group_delay_func = &FilterParam::group_delay_mo;
-			stability_func = &FilterParam::judge_stability_odd;
+			cascade_type = CascadeType::MO;
 		}
 	}
 	else
 	{
 		if ((m_order % 2) == 0)
 		{
-			freq_res_func = &FilterParam::freq_res_no;
-			group_delay_func = &FilterParam::group_delay_no;
-			stability_func = &FilterParam::judge_stability_even;
+			cascade_type = CascadeType::NO;
 		}
 		else
 		{
-			freq_res_func = &FilterParam::freq_res_so;
-			group_delay_func = &FilterParam::group_delay_so;
-			stability_func = &FilterParam::judge_stability_odd;
+			cascade_type = CascadeType::SO;
 		}
 	}
+
+	// decide using kernel
+	set_fixed_order(true);
+}
+
+void FilterParam::set_fixed_order(bool input)
+{
+	fixed_order = input && fixed_cascade_kernels(n_order, m_order, kernels);
 }
 
 /* # フィルタ構造体
@@ -584,403 +576,1473 @@ vector<complex<double>> FilterParam::gen_desire_res
 	return desire;
 }
 
-vector<vector<complex<double>>> FilterParam::freq_res_se(const vector<double>& coef) const
+/* # フィルタ構造体
+ *   全帯域の複素正弦波と所望特性を連続した周波数グリッドにまとめる
+ *   各帯域の値はgen_csw, gen_csw2, gen_desire_resと同一
+ *
+ * # 引数
+ * vector<BandParam>& bands : 周波数帯域の配列
+ * vector<unsigned int>& split : 帯域ごとの分割数
+ * double group_delay : 所望群遅延
+ * # 返り値
+ * FreqGrid grid : 全帯域を連結した周波数グリッド
+ */
+FreqGrid FilterParam::gen_grid
+(const vector<BandParam>& bands, const vector<unsigned int>& split, const double group_delay)
 {
-	vector<vector<complex<double>>> res;
-		res.reserve(bands.size());
+	FreqGrid grid;
+	unsigned int total = 0;
+	for (auto n : split)
+	{
+		total += n;
+	}
+
+	grid.csw_re.reserve(total);
+	grid.csw_im.reserve(total);
+	grid.csw2_re.reserve(total);
+	grid.csw2_im.reserve(total);
+	grid.desire_re.reserve(total);
+	grid.desire_im.reserve(total);
+	grid.desire_mag.reserve(total);
+	grid.band_type.reserve(total);
+	grid.band_offset.reserve(bands.size() + 1);
 
-	for (unsigned int i = 0; i < bands.size(); ++i)    // 周波数帯域のループ
+	for (unsigned int i = 0; i < bands.size(); ++i)
 	{
-		vector<complex<double>> band_res;
-			band_res.reserve(csw.at(i).size());
+		auto csw = gen_csw(bands.at(i), split.at(i));
+		auto csw2 = gen_csw2(bands.at(i), split.at(i));
+		auto desire = gen_desire_res(bands.at(i), split.at(i), group_delay);
 
-		for (unsigned int j = 0; j < csw.at(i).size(); ++j)  // 周波数帯域内の分割数によるループ
+		for (unsigned int j = 0; j < split.at(i); ++j)
 		{
-			complex<double> frac_over(1.0, 1.0);
-			complex<double> frac_under(1.0, 1.0);
-
-			for (unsigned int n = 1; n < n_order; n += 2)
-			{
-				frac_over *= 1.0 + coef.at(n)*csw.at(i).at(j) + coef.at(n + 1)*csw2.at(i).at(j);
-			}
-			for (unsigned int m = n_order + 1; m < opt_order(); m += 2)
-			{
-				frac_under *= 1.0 + coef.at(m)*csw.at(i).at(j) + coef.at(m + 1)*csw2.at(i).at(j);
-			}
-			band_res.emplace_back( coef.at(0)*(frac_over / frac_under) );
+			grid.csw_re.emplace_back(csw.at(j).real());
+			grid.csw_im.emplace_back(csw.at(j).imag());
+			grid.csw2_re.emplace_back(csw2.at(j).real());
+			grid.csw2_im.emplace_back(csw2.at(j).imag());
+			grid.desire_re.emplace_back(j < desire.size() ? desire.at(j).real() : 0.0);
+			grid.desire_im.emplace_back(j < desire.size() ? desire.at(j).imag() : 0.0);
+			grid.desire_mag.emplace_back(j < desire.size() ? abs(desire.at(j)) : 0.0);
+			grid.band_type.emplace_back(bands.at(i).type());
 		}
-		res.emplace_back(band_res);
+		grid.band_offset.emplace_back(grid.band_offset.back() + split.at(i));
 	}
 
-	return res;
+	return grid;
 }
 
-vector<vector<complex<double>>> FilterParam::freq_res_so(const vector<double> &coef) const
-{
-	vector<vector<complex<double>>> res;
-		res.reserve(bands.size());
+constexpr unsigned int EvalOrder::block_size;
+constexpr double EvalOrder::smoothing;
 
-	for (unsigned int i = 0; i < bands.size(); ++i)    // 周波数帯域のループ
+/* # 打ち切り評価の順序
+ *   周波数グリッドを帯域をまたがないブロックに分け，先頭から順に並べる
+ */
+void EvalOrder::reset(const FreqGrid& grid)
+{
+	begin.clear();
+	end.clear();
+	type.clear();
+	for (unsigned int i = 0; i < grid.nband(); ++i)
 	{
-		vector<complex<double>> band_res;
-			band_res.reserve(csw.at(i).size());
-
-		for (unsigned int j = 0; j < csw.at(i).size(); ++j)  // 周波数帯域内の分割数によるループ
+		for (unsigned int j = grid.band_begin(i); j < grid.band_end(i); j += block_size)
 		{
-			complex<double> frac_over(1.0, 1.0);
-			complex<double> frac_under(1.0, 1.0);
-
-			frac_over *= 1.0 + coef.at(1)*csw.at(i).at(j);
-			for (unsigned int n = 2; n < n_order; n += 2)
-			{
-				frac_over *= 1.0 + coef.at(n)*csw.at(i).at(j) + coef.at(n + 1)*csw2.at(i).at(j);
-			}
-
-			frac_under *= 1.0 + coef.at(n_order + 1)*csw.at(i).at(j);
-			for (unsigned int m = n_order + 2; m < opt_order(); m += 2)
-			{
-				frac_under *= 1.0 + coef.at(m)*csw.at(i).at(j) + coef.at(m + 1)*csw2.at(i).at(j);
-			}
-
-			band_res.emplace_back( coef.at(0)*(frac_over / frac_under) );
+			begin.emplace_back(j);
+			end.emplace_back(min(j + block_size, grid.band_end(i)));
+			type.emplace_back(grid.band_type[j]);
 		}
-		res.emplace_back(band_res);
 	}
-	return res;
+
+	score.assign(begin.size(), 0.0);
+	order.resize(begin.size());
+	for (unsigned int k = 0; k < order.size(); ++k)
+	{
+		order[k] = k;
+	}
+	band_offset = grid.band_offset;
 }
 
-vector<vector<complex<double>>> FilterParam::freq_res_no(const vector<double>& coef) const
+/* # 打ち切り評価の順序
+ *   ブロックbで得られた誤差をスコアの指数移動平均に反映する
+ */
+void EvalOrder::update(const unsigned int b, const double error)
 {
-	vector<vector<complex<double>>> freq;
-		freq.reserve(bands.size());
+	score[b] += smoothing*(error - score[b]);
+}
 
-	for (unsigned int i = 0; i < bands.size(); ++i)    // 周波数帯域のループ
+/* # 打ち切り評価の順序
+ *   スコアの降順に並べ替える
+ *   前回の順序からの変化は小さいため挿入ソートで行う
+ */
+void EvalOrder::sort()
+{
+	for (unsigned int k = 1; k < order.size(); ++k)
 	{
-		vector<complex<double>> freq_band;
-			freq_band.reserve(csw.at(i).size());
-
-		for (unsigned int j = 0; j < csw.at(i).size(); ++j)  // 周波数帯域内の分割数によるループ
+		const unsigned int b = order[k];
+		unsigned int l = k;
+		for (; l > 0 && score[order[l - 1]] < score[b]; --l)
 		{
-			complex<double> freq_denominator(1.0, 1.0);
-			complex<double> freq_numerator(1.0, 1.0);
-
-			freq_numerator *= 1.0 + coef.at(1)*csw.at(i).at(j);
-			for (unsigned int n = 2; n < n_order; n += 2)		//分子の総乗ループ
-			{
-				freq_numerator *= 1.0 + coef.at(n)*csw.at(i).at(j) + coef.at(n + 1)*csw2.at(i).at(j);
-			}
-			for (unsigned int m = n_order + 1; m < opt_order(); m += 2)		//分母の総乗ループ
-			{
-				freq_denominator *= 1.0 + coef.at(m)*csw.at(i).at(j) + coef.at(m + 1)*csw2.at(i).at(j);
-			}
-
-			freq_band.emplace_back( coef.at(0)*(freq_numerator / freq_denominator));
+			order[l] = order[l - 1];
 		}
-		freq.emplace_back(freq_band);
+		order[l] = b;
 	}
-	
-	return freq;
 }
 
-vector<vector<complex<double>>> FilterParam::freq_res_mo(const vector<double>& coef) const
+/* # フィルタ構造体
+ *   スレッドごとに1つ保持する作業領域
+ *   引数に作業領域を取らない関数が内部で使い回す
+ */
+FilterWorkspace& FilterParam::local_workspace()
 {
-	vector<vector<complex<double>>> freq;
-		freq.reserve(bands.size());
+	thread_local FilterWorkspace workspace;
+	return workspace;
+}
 
-	for (unsigned int i = 0; i < bands.size(); ++i) // 周波数帯域のループ
+void FilterParam::freq_res(const vector<double>& coef, vector<vector<complex<double>>>& res) const
+{
+	if (coef.size() != opt_order())
 	{
-		vector<complex<double>> freq_band;
-			freq_band.reserve(csw.at(i).size());
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, coef.size(), opt_order());
+		exit(EXIT_FAILURE);
+	}
 
-		for (unsigned int j = 0; j < csw.at(i).size(); ++j) // 周波数帯域内の分割数によるループ
-		{
-			complex<double> nume(1.0, 1.0);
-			complex<double> deno(1.0, 1.0);
+	FilterWorkspace& ws = local_workspace();
+	ws.reserve(grid.size());
+	freq_res(coef.data(), ws.re.data(), ws.im.data());
 
-			for (unsigned int n = 1; n < n_order; n += 2)
-			{
-				nume *= 1.0 + coef.at(n)*csw.at(i).at(j) + coef.at(n + 1)*csw2.at(i).at(j);
-			}
-			deno *= 1.0 + coef.at(n_order + 1)*csw.at(i).at(j);
-			for (unsigned int m = n_order + 2; m < opt_order(); m += 2)
-			{
-				deno *= 1.0 + coef.at(m)*csw.at(i).at(j) + coef.at(m + 1)*csw2.at(i).at(j);
-			}
-		freq_band.emplace_back( coef.at(0)*(nume / deno) );
+	res.resize(grid.nband());
+	for (unsigned int i = 0; i < grid.nband(); ++i)    // 周波数帯域のループ
+	{
+		res[i].resize(grid.band_size(i));
+		for (unsigned int j = grid.band_begin(i); j < grid.band_end(i); ++j)
+		{
+			res[i][j - grid.band_begin(i)] = complex<double>(ws.re[j], ws.im[j]);
 		}
-		freq.emplace_back(freq_band);
-
 	}
-	return freq;
 }
 
-vector<vector<double>> FilterParam::group_delay_se(const vector<double> &coef) const
+void FilterParam::group_delay_res(const vector<double>& coef, vector<vector<double>>& res) const
 {
-	vector<vector<double>> res;
-		res.reserve(bands.size());
+	if (coef.size() != opt_order())
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, coef.size(), opt_order());
+		exit(EXIT_FAILURE);
+	}
+
+	FilterWorkspace& ws = local_workspace();
+	ws.reserve(grid.size());
+	group_delay_res(coef.data(), ws.gd.data());
 
-	for (unsigned int i = 0; i < bands.size(); ++i)    // 周波数帯域のループ
+	res.resize(grid.nband());
+	for (unsigned int i = 0; i < grid.nband(); ++i)    // 周波数帯域のループ
 	{
-		vector<double> band_res;
-			band_res.reserve(csw.at(i).size());
+		res[i].assign(ws.gd.begin() + grid.band_begin(i), ws.gd.begin() + grid.band_end(i));
+	}
+}
 
-		for (unsigned int j = 0; j < csw.at(i).size(); ++j)  // 周波数帯域内の分割数によるループ
-		{
-			complex<double> second_over(0.0, 0.0);
-			complex<double> second_under(0.0, 0.0);
+void FilterParam::freq_gd_res
+(const vector<double>& coef, vector<vector<complex<double>>>& res, vector<vector<double>>& gd) const
+{
+	if (coef.size() != opt_order())
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, coef.size(), opt_order());
+		exit(EXIT_FAILURE);
+	}
 
-			for (unsigned int n = 1; n < n_order; n += 2)
-			{
-				second_over +=
-					(coef.at(n)*csw.at(i).at(j) + 2.0*coef.at(n + 1)*csw2.at(i).at(j))
-					/
-					(1.0 + coef.at(n)*csw.at(i).at(j) + coef.at(n + 1)*csw2.at(i).at(j));
-			}
-			for (unsigned int m = n_order + 1; m < opt_order(); m += 2)
-			{
-				second_under +=
-					(coef.at(m)*csw.at(i).at(j) + 2.0*coef.at(m + 1)*csw2.at(i).at(j))
-					/
-					(1.0 + coef.at(m)*csw.at(i).at(j) + coef.at(m + 1)*csw2.at(i).at(j));
-			}
-			complex<double> second_gd = second_over - second_under;
+	FilterWorkspace& ws = local_workspace();
+	ws.reserve(grid.size());
+	freq_gd_res(coef.data(), ws.re.data(), ws.im.data(), ws.gd.data());
 
-			band_res.emplace_back(second_gd.real());
+	res.resize(grid.nband());
+	gd.resize(grid.nband());
+	for (unsigned int i = 0; i < grid.nband(); ++i)    // 周波数帯域のループ
+	{
+		res[i].resize(grid.band_size(i));
+		for (unsigned int j = grid.band_begin(i); j < grid.band_end(i); ++j)
+		{
+			res[i][j - grid.band_begin(i)] = complex<double>(ws.re[j], ws.im[j]);
 		}
-		res.emplace_back(band_res);
+		gd[i].assign(ws.gd.begin() + grid.band_begin(i), ws.gd.begin() + grid.band_end(i));
 	}
-	return res;
 }
 
-vector<vector<double>> FilterParam::group_delay_so(const vector<double> &coef) const
+void FilterParam::freq_res(const double* coef, double* re, double* im) const
 {
-	vector<vector<double>> res;
-		res.reserve(bands.size());
-
-	for (unsigned int i = 0; i < bands.size(); ++i)    // 周波数帯域のループ
+	if (fixed_order)
 	{
-		vector<double> band_res;
-			band_res.reserve(csw.at(i).size());
-
-		for (unsigned int j = 0; j < csw.at(i).size(); ++j)  // 周波数帯域内の分割数によるループ
-		{
-			complex<double> prime_over = (1.0 + coef.at(1)*csw.at(i).at(j)) / (coef.at(1)*csw.at(i).at(j));
-			complex<double> prime_under = (1.0 + coef.at(n_order + 1)*csw.at(i).at(j)) / (coef.at(n_order + 1)*csw.at(i).at(j));
-			complex<double> prime_gd = prime_over - prime_under;
+		kernels.res(coef, n_order, m_order, grid, 0, grid.size(), re, im);
+		return;
+	}
 
-			complex<double> second_over(0.0, 0.0);
-			complex<double> second_under(0.0, 0.0);
+	switch (cascade_type)
+	{
+		case CascadeType::SE:
+			cascade_res<DynamicOrder<false, false>>(coef, n_order, m_order, grid, 0, grid.size(), re, im);
+			break;
+		case CascadeType::SO:
+			cascade_res<DynamicOrder<true, true>>(coef, n_order, m_order, grid, 0, grid.size(), re, im);
+			break;
+		case CascadeType::NO:
+			cascade_res<DynamicOrder<true, false>>(coef, n_order, m_order, grid, 0, grid.size(), re, im);
+			break;
+		case CascadeType::MO:
+			cascade_res<DynamicOrder<false, true>>(coef, n_order, m_order, grid, 0, grid.size(), re, im);
+			break;
+	}
+}
 
-			for (unsigned int n = 2; n < n_order; n += 2)
-			{
-				second_over +=
-					(coef.at(n)*csw.at(i).at(j) + 2.0*coef.at(n + 1)*csw2.at(i).at(j))
-					/
-					(1.0 + coef.at(n)*csw.at(i).at(j) + coef.at(n + 1)*csw2.at(i).at(j));
-			}
-			for (unsigned int m = n_order + 2; m < opt_order(); m += 2)
-			{
-				second_under +=
-					(coef.at(m)*csw.at(i).at(j) + 2.0*coef.at(m + 1)*csw2.at(i).at(j))
-					/
-					(1.0 + coef.at(m)*csw.at(i).at(j) + coef.at(m + 1)*csw2.at(i).at(j));
-			}
-			complex<double> second_gd = second_over - second_under;
+void FilterParam::group_delay_res(const double* coef, double* gd) const
+{
+	if (fixed_order)
+	{
+		kernels.gd(coef, n_order, m_order, grid, 0, grid.size(), gd);
+		return;
+	}
 
-			band_res.emplace_back( (prime_gd + second_gd).real() );
-		}
-		res.emplace_back(band_res);
+	switch (cascade_type)
+	{
+		case CascadeType::SE:
+			cascade_gd<DynamicOrder<false, false>>(coef, n_order, m_order, grid, 0, grid.size(), gd);
+			break;
+		case CascadeType::SO:
+			cascade_gd<DynamicOrder<true, true>>(coef, n_order, m_order, grid, 0, grid.size(), gd);
+			break;
+		case CascadeType::NO:
+			cascade_gd<DynamicOrder<true, false>>(coef, n_order, m_order, grid, 0, grid.size(), gd);
+			break;
+		case CascadeType::MO:
+			cascade_gd<DynamicOrder<false, true>>(coef, n_order, m_order, grid, 0, grid.size(), gd);
+			break;
 	}
-	return res;
 }
 
-vector<vector<double>> FilterParam::group_delay_no(const vector<double> &coef) const
+void FilterParam::freq_gd_res(const double* coef, double* re, double* im, double* gd) const
 {
-	vector<vector<double>> res;
-		res.reserve(bands.size());
-
-	for (unsigned int i = 0; i < bands.size(); ++i)    // 周波数帯域のループ
+	if (fixed_order)
 	{
-		vector<double> band_res;
-			band_res.reserve(csw.at(i).size());
+		kernels.res_gd(coef, n_order, m_order, grid, 0, grid.size(), re, im, gd);
+		return;
+	}
 
-		for (unsigned int j = 0; j < csw.at(i).size(); ++j)  // 周波数帯域内の分割数によるループ
-		{
-			complex<double> prime_gd = (1.0 + coef.at(1)*csw.at(i).at(j)) / (coef.at(1)*csw.at(i).at(j));  // calculate fractional over
+	switch (cascade_type)
+	{
+		case CascadeType::SE:
+			cascade_res_gd<DynamicOrder<false, false>>(coef, n_order, m_order, grid, 0, grid.size(), re, im, gd);
+			break;
+		case CascadeType::SO:
+			cascade_res_gd<DynamicOrder<true, true>>(coef, n_order, m_order, grid, 0, grid.size(), re, im, gd);
+			break;
+		case CascadeType::NO:
+			cascade_res_gd<DynamicOrder<true, false>>(coef, n_order, m_order, grid, 0, grid.size(), re, im, gd);
+			break;
+		case CascadeType::MO:
+			cascade_res_gd<DynamicOrder<false, true>>(coef, n_order, m_order, grid, 0, grid.size(), re, im, gd);
+			break;
+	}
+}
 
-			complex<double> second_over(0.0, 0.0);
-			complex<double> second_under(0.0, 0.0);
+vector<vector<double>> FilterParam::power_res(const vector<double>& coef) const
+{
+	if (coef.size() != opt_order())
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, coef.size(), opt_order());
+		exit(EXIT_FAILURE);
+	}
 
-			for (unsigned int n = 2; n < n_order; n += 2)
-			{
-				second_over +=
-					(coef.at(n)*csw.at(i).at(j) + 2.0*coef.at(n + 1)*csw2.at(i).at(j))
-					/
-					(1.0 + coef.at(n)*csw.at(i).at(j) + coef.at(n + 1)*csw2.at(i).at(j));
-			}
-			for (unsigned int m = n_order + 1; m < opt_order(); m += 2)
-			{
-				second_under +=
-					(coef.at(m)*csw.at(i).at(j) + 2.0*coef.at(m + 1)*csw2.at(i).at(j))
-					/
-					(1.0 + coef.at(m)*csw.at(i).at(j) + coef.at(m + 1)*csw2.at(i).at(j));
-			}
-			complex<double> second_gd = second_over - second_under;
+	FilterWorkspace& ws = local_workspace();
+	ws.reserve(grid.size());
+	power_res(coef.data(), ws.re.data());
 
-			band_res.emplace_back( (prime_gd + second_gd).real() );
-		}
-		res.emplace_back(band_res);
+	vector<vector<double>> res(grid.nband());
+	for (unsigned int i = 0; i < grid.nband(); ++i)    // 周波数帯域のループ
+	{
+		res[i].assign(ws.re.begin() + grid.band_begin(i), ws.re.begin() + grid.band_end(i));
 	}
 	return res;
 }
 
-vector<vector<double>> FilterParam::group_delay_mo(const vector<double> &coef) const
+void FilterParam::power_res(const double* coef, double* power) const
 {
-	vector<vector<double>> res;
-		res.reserve(bands.size());
-
-	for (unsigned int i = 0; i < bands.size(); ++i)    // 周波数帯域のループ
+	if (fixed_order)
 	{
-		vector<double> band_res;
-			band_res.reserve(csw.at(i).size());
-
-		for (unsigned int j = 0; j < csw.at(i).size(); ++j)  // 周波数帯域内の分割数によるループ
-		{
-			complex<double> prime_gd = -(1.0 + coef.at(n_order + 1)*csw.at(i).at(j)) / (coef.at(n_order + 1)*csw.at(i).at(j));   // calculate fractional under
-			
-			complex<double> second_over(0.0, 0.0);
-			complex<double> second_under(0.0, 0.0);
-
-			for (unsigned int n = 1; n < n_order; n += 2)
-			{
-				second_over +=
-					(coef.at(n)*csw.at(i).at(j) + 2.0*coef.at(n + 1)*csw2.at(i).at(j))
-					/
-					(1.0 + coef.at(n)*csw.at(i).at(j) + coef.at(n + 1)*csw2.at(i).at(j));
-			}
-			for (unsigned int m = n_order + 2; m < opt_order(); m += 2)
-			{
-				second_under +=
-					(coef.at(m)*csw.at(i).at(j) + 2.0*coef.at(m + 1)*csw2.at(i).at(j))
-					/
-					(1.0 + coef.at(m)*csw.at(i).at(j) + coef.at(m + 1)*csw2.at(i).at(j));
-			}
-			complex<double> second_gd = second_over - second_under;
+		kernels.power(coef, n_order, m_order, grid, 0, grid.size(), power);
+		return;
+	}
 
-			band_res.emplace_back( (prime_gd + second_gd).real() );
-		}
-		res.emplace_back(band_res);
+	switch (cascade_type)
+	{
+		case CascadeType::SE:
+			cascade_power<DynamicOrder<false, false>>(coef, n_order, m_order, grid, 0, grid.size(), power);
+			break;
+		case CascadeType::SO:
+			cascade_power<DynamicOrder<true, true>>(coef, n_order, m_order, grid, 0, grid.size(), power);
+			break;
+		case CascadeType::NO:
+			cascade_power<DynamicOrder<true, false>>(coef, n_order, m_order, grid, 0, grid.size(), power);
+			break;
+		case CascadeType::MO:
+			cascade_power<DynamicOrder<false, true>>(coef, n_order, m_order, grid, 0, grid.size(), power);
+			break;
 	}
-	return res;
 }
 
-double FilterParam::judge_stability_even(const vector<double>& coef) const
+void FilterParam::residual_jacobian(const vector<double>& coef, vector<double>& res, vector<double>& jac) const
 {
-	double penalty = 0.0;
+	if (coef.size() != opt_order())
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, coef.size(), opt_order());
+		exit(EXIT_FAILURE);
+	}
 
-	for (unsigned int n = n_order + 1; n < this->opt_order(); n += 2)
+	res.resize(2*grid.size());
+	jac.resize((size_t)opt_order()*2*grid.size());
+	residual_jacobian(coef.data(), res.data(), jac.data());
+}
+
+void FilterParam::residual_jacobian(const double* coef, double* res, double* jac) const
+{
+	switch (cascade_type)
 	{
-		if(abs(coef.at(n+1)) >= 1 || coef.at(n+1) <= abs(coef.at(n)) - 1)
-		{
-			penalty += coef.at(n)*coef.at(n) + coef.at(n+1)*coef.at(n+1);
-		}
+		case CascadeType::SE:
+			cascade_res_jac<false, false>(coef, n_order, m_order, grid, res, jac);
+			break;
+		case CascadeType::SO:
+			cascade_res_jac<true, true>(coef, n_order, m_order, grid, res, jac);
+			break;
+		case CascadeType::NO:
+			cascade_res_jac<true, false>(coef, n_order, m_order, grid, res, jac);
+			break;
+		case CascadeType::MO:
+			cascade_res_jac<false, true>(coef, n_order, m_order, grid, res, jac);
+			break;
 	}
-	return penalty;
 }
 
-double FilterParam::judge_stability_odd(const vector<double>& coef) const
+void FilterParam::expand_poly(const vector<double>& coef, vector<double>& num, vector<double>& den) const
 {
-	double penalty = 0.0;
-	
-	if(abs(coef.at(n_order + 1)) >= 1)
+	if (coef.size() != opt_order())
 	{
-    	penalty += coef.at(n_order + 1)*coef.at(n_order + 1);
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, coef.size(), opt_order());
+		exit(EXIT_FAILURE);
 	}
-	for(unsigned int m = n_order + 2; m < opt_order(); m += 2)
+
+	// 多項式polyに節(1 + c1 z^-1 + c2 z^-2)を掛ける
+	auto mul_poly = [](vector<double>& poly, const double c1, const double c2)
 	{
-		if(abs(coef.at(m + 1)) >= 1 || coef.at(m + 1) <= abs(coef.at(m)) - 1)
+		poly.push_back(0.0);
+		poly.push_back(0.0);
+		for (unsigned int i = poly.size() - 1; i >= 1; --i)
 		{
-			penalty += coef.at(m)*coef.at(m) + coef.at(m + 1)*coef.at(m + 1);
+			poly[i] += c1*poly[i - 1] + (i >= 2 ? c2*poly[i - 2] : 0.0);
 		}
+	};
+
+	num.assign(1, coef[0]);
+	unsigned int n = 1;
+	if (n_order % 2 == 1)
+	{
+		mul_poly(num, coef[1], 0.0);
+		n = 2;
+	}
+	for (; n < n_order; n += 2)
+	{
+		mul_poly(num, coef[n], coef[n + 1]);
 	}
+	num.resize(n_order + 1);
 
-	return penalty;
+	den.assign(1, 1.0);
+	unsigned int m = n_order + 1;
+	if (m_order % 2 == 1)
+	{
+		mul_poly(den, coef[n_order + 1], 0.0);
+		m = n_order + 2;
+	}
+	for (; m < opt_order(); m += 2)
+	{
+		mul_poly(den, coef[m], coef[m + 1]);
+	}
+	den.resize(m_order + 1);
 }
 
-/* # フィルタ構造体
- *   ペナルティ関数法による目的関数値を計算する
- *
- */
-double FilterParam::evaluate(const vector<double> &coef) const
+vector<complex<double>> FilterParam::dense_freq_res(const vector<double>& coef, const unsigned int nfft) const
 {
-	constexpr double cs = 100;	//安定性のペナルティの重み
-	constexpr double ct = 100;	//振幅隆起のペナルティの重み
-
-	double max_error = 0.0;	//最大誤差
-	double max_riple = 0.0;	//振幅隆起のペナルティの値
+	if (!is_power_of_two(nfft) || nfft <= max(n_order, m_order) || nfft < 2)
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]FFT length must be a power of two larger than the order.(length : %u, order : %u/%u)\n",
+			__FILE__, __LINE__, nfft, n_order, m_order);
+		exit(EXIT_FAILURE);
+	}
 
-	double penalty_stability = judge_stability(coef);
-	vector<vector<complex<double>>> freq = freq_res(coef);
+	if (coef.size() != opt_order())
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, coef.size(), opt_order());
+		exit(EXIT_FAILURE);
+	}
 
-	for (unsigned int i = 0; i < bands.size(); ++i)    // 周波数帯域のループ
+	// 節(1 + c1 e^-jω + c2 e^-j2ω)を(pr, pi)に掛ける
+	auto mul_section = [](double& pr, double& pi, const double c1, const double c2,
+		const double zr, const double zi, const double z2r, const double z2i)
+	{
+		const double sr = 1.0 + c1*zr + c2*z2r;
+		const double si = c1*zi + c2*z2i;
+		const double r = pr*sr - pi*si;
+		pi = pr*si + pi*sr;
+		pr = r;
+	};
+
+	vector<complex<double>> res(nfft/2 + 1);
+	const double dpi = -2.0*M_PI/nfft;
+	for (unsigned int k = 0; k <= nfft/2; ++k)
 	{
-		for (unsigned int j = 0; j < csw.at(i).size(); ++j)  // 周波数帯域内の分割数によるループ
+		const double zr = cos(dpi*k), zi = sin(dpi*k);			// e^-jω
+		const double z2r = zr*zr - zi*zi, z2i = 2.0*zr*zi;		// e^-j2ω
+		double nr = coef[0], ni = 0.0, dr = 1.0, di = 0.0;
+
+		unsigned int i = 1;
+		if (n_order % 2 == 1)
 		{
-			switch (bands.at(i).type())	
-			{
-				case BandType::Pass:
-				case BandType::Stop:
-				{
-					double error = abs(desire_res.at(i).at(j) - freq.at(i).at(j));
-					if(max_error < error)
-					{
-						max_error = error;
-					}
-					break;
-				}
-				case BandType::Transition:
-				{
-					double current_riple = abs(freq.at(i).at(j));
-					if(current_riple > threshold_riple && current_riple > max_riple)
-					{
-						max_riple = current_riple;
-					}
-					break;
-				}
-			}
+			mul_section(nr, ni, coef[i], 0.0, zr, zi, z2r, z2i);
+			++i;
+		}
+		for (; i < n_order + 1; i += 2)
+		{
+			mul_section(nr, ni, coef[i], coef[i + 1], zr, zi, z2r, z2i);
+		}
+		if (m_order % 2 == 1)
+		{
+			mul_section(dr, di, coef[i], 0.0, zr, zi, z2r, z2i);
+			++i;
+		}
+		for (; i < opt_order(); i += 2)
+		{
+			mul_section(dr, di, coef[i], coef[i + 1], zr, zi, z2r, z2i);
 		}
+
+		const double scale = 1.0 / (dr*dr + di*di);
+		res[k] = complex<double>((nr*dr + ni*di)*scale, (ni*dr - nr*di)*scale);
 	}
-	return(max_error + ct*max_riple*max_riple + cs*penalty_stability);
+	return res;
 }
 
-vector<double> FilterParam::init_coef(const double a0, const double a, const double b) const
+vector<complex<double>> FilterParam::dense_freq_res_fft(const vector<double>& coef, const unsigned int nfft) const
 {
-	thread_local random_device rnd;
-	thread_local mt19937 mt(rnd());
-	uniform_real_distribution<> a0_range(-abs(a0), abs(a0));
-	uniform_real_distribution<> a_range(-abs(a), abs(a));
-	uniform_real_distribution<> b_range(-abs(b), abs(b));
+	if (!is_power_of_two(nfft) || nfft <= max(n_order, m_order) || nfft < 2)
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]FFT length must be a power of two larger than the order.(length : %u, order : %u/%u)\n",
+			__FILE__, __LINE__, nfft, n_order, m_order);
+		exit(EXIT_FAILURE);
+	}
 
-	vector<double> coef;
-		coef.reserve(this->opt_order());
+	vector<double> num, den;
+	expand_poly(coef, num, den);
+	num.resize(nfft, 0.0);
+	den.resize(nfft, 0.0);
 
-	coef.emplace_back(a0_range(mt));
-	for (unsigned int n = 0; n < n_order; ++n)
+	vector<complex<double>> num_res, den_res;
+	rfft(num, num_res);
+	rfft(den, den_res);
+
+	// complex<double>の除算は__divdc3の呼び出しになるため実数演算で割る
+	for (unsigned int k = 0; k < num_res.size(); ++k)
 	{
-		coef.emplace_back(a_range(mt));
+		const double nr = num_res[k].real(), ni = num_res[k].imag();
+		const double dr = den_res[k].real(), di = den_res[k].imag();
+		const double scale = 1.0 / (dr*dr + di*di);
+		num_res[k] = complex<double>((nr*dr + ni*di)*scale, (ni*dr - nr*di)*scale);
 	}
-	for (unsigned int m = 0; m < m_order; ++m)
+	return num_res;
+}
+
+/* # フィルタ構造体
+ *   周波数グリッドの[begin : end)の点の最大誤差でmax_errorを更新する
+ */
+void FilterParam::error_kernel
+(const double* coef, const unsigned int begin, const unsigned int end, double& max_error) const
+{
+	if (fixed_order)
 	{
-		coef.emplace_back(b_range(mt));
+		kernels.error(coef, n_order, m_order, grid, begin, end, max_error);
+		return;
 	}
 
-	return coef;
+	switch (cascade_type)
+	{
+		case CascadeType::SE:
+			cascade_error<DynamicOrder<false, false>>(coef, n_order, m_order, grid, begin, end, max_error);
+			break;
+		case CascadeType::SO:
+			cascade_error<DynamicOrder<true, true>>(coef, n_order, m_order, grid, begin, end, max_error);
+			break;
+		case CascadeType::NO:
+			cascade_error<DynamicOrder<true, false>>(coef, n_order, m_order, grid, begin, end, max_error);
+			break;
+		case CascadeType::MO:
+			cascade_error<DynamicOrder<false, true>>(coef, n_order, m_order, grid, begin, end, max_error);
+			break;
+	}
 }
 
-vector<double> FilterParam::init_stable_coef(const double a0, const double a) const
+/* # フィルタ構造体
+ *   周波数グリッドの[begin : end)の点の最大振幅隆起でmax_ripleを更新する
+ */
+void FilterParam::riple_kernel
+(const double* coef, const unsigned int begin, const unsigned int end, double& max_riple) const
+{
+	if (fixed_order)
+	{
+		kernels.riple(coef, n_order, m_order, grid, begin, end, threshold_riple, max_riple);
+		return;
+	}
+
+	switch (cascade_type)
+	{
+		case CascadeType::SE:
+			cascade_riple<DynamicOrder<false, false>>(coef, n_order, m_order, grid, begin, end, threshold_riple, max_riple);
+			break;
+		case CascadeType::SO:
+			cascade_riple<DynamicOrder<true, true>>(coef, n_order, m_order, grid, begin, end, threshold_riple, max_riple);
+			break;
+		case CascadeType::NO:
+			cascade_riple<DynamicOrder<true, false>>(coef, n_order, m_order, grid, begin, end, threshold_riple, max_riple);
+			break;
+		case CascadeType::MO:
+			cascade_riple<DynamicOrder<false, true>>(coef, n_order, m_order, grid, begin, end, threshold_riple, max_riple);
+			break;
+	}
+}
+
+/* # フィルタ構造体
+ *   周波数グリッドの[begin : end)の点の最大振幅誤差でmax_errorを更新する(EvalMode::Magnitude)
+ */
+void FilterParam::error_mag_kernel
+(const double* coef, const unsigned int begin, const unsigned int end, double& max_error) const
+{
+	if (fixed_order)
+	{
+		kernels.error_mag(coef, n_order, m_order, grid, begin, end, max_error);
+		return;
+	}
+
+	switch (cascade_type)
+	{
+		case CascadeType::SE:
+			cascade_error_mag<DynamicOrder<false, false>>(coef, n_order, m_order, grid, begin, end, max_error);
+			break;
+		case CascadeType::SO:
+			cascade_error_mag<DynamicOrder<true, true>>(coef, n_order, m_order, grid, begin, end, max_error);
+			break;
+		case CascadeType::NO:
+			cascade_error_mag<DynamicOrder<true, false>>(coef, n_order, m_order, grid, begin, end, max_error);
+			break;
+		case CascadeType::MO:
+			cascade_error_mag<DynamicOrder<false, true>>(coef, n_order, m_order, grid, begin, end, max_error);
+			break;
+	}
+}
+
+/* # フィルタ構造体
+ *   周波数グリッドの[begin : end)の点の最大振幅隆起でmax_ripleを更新する(実数演算版)
+ */
+void FilterParam::riple_mag_kernel
+(const double* coef, const unsigned int begin, const unsigned int end, double& max_riple) const
+{
+	if (fixed_order)
+	{
+		kernels.riple_mag(coef, n_order, m_order, grid, begin, end, threshold_riple, max_riple);
+		return;
+	}
+
+	switch (cascade_type)
+	{
+		case CascadeType::SE:
+			cascade_riple_mag<DynamicOrder<false, false>>(coef, n_order, m_order, grid, begin, end, threshold_riple, max_riple);
+			break;
+		case CascadeType::SO:
+			cascade_riple_mag<DynamicOrder<true, true>>(coef, n_order, m_order, grid, begin, end, threshold_riple, max_riple);
+			break;
+		case CascadeType::NO:
+			cascade_riple_mag<DynamicOrder<true, false>>(coef, n_order, m_order, grid, begin, end, threshold_riple, max_riple);
+			break;
+		case CascadeType::MO:
+			cascade_riple_mag<DynamicOrder<false, true>>(coef, n_order, m_order, grid, begin, end, threshold_riple, max_riple);
+			break;
+	}
+}
+
+/* # フィルタ構造体
+ *   周波数グリッドの[begin : end)の点の最大誤差でmax_errorを，
+ *   群遅延と所望群遅延の差の最大値でmax_gdを更新する
+ */
+void FilterParam::error_gd_kernel
+(const double* coef, const unsigned int begin, const unsigned int end, double& max_error, double& max_gd) const
+{
+	if (fixed_order)
+	{
+		kernels.error_gd(coef, n_order, m_order, grid, begin, end, group_delay, max_error, max_gd);
+		return;
+	}
+
+	switch (cascade_type)
+	{
+		case CascadeType::SE:
+			cascade_error_gd<DynamicOrder<false, false>>(coef, n_order, m_order, grid, begin, end, group_delay, max_error, max_gd);
+			break;
+		case CascadeType::SO:
+			cascade_error_gd<DynamicOrder<true, true>>(coef, n_order, m_order, grid, begin, end, group_delay, max_error, max_gd);
+			break;
+		case CascadeType::NO:
+			cascade_error_gd<DynamicOrder<true, false>>(coef, n_order, m_order, grid, begin, end, group_delay, max_error, max_gd);
+			break;
+		case CascadeType::MO:
+			cascade_error_gd<DynamicOrder<false, true>>(coef, n_order, m_order, grid, begin, end, group_delay, max_error, max_gd);
+			break;
+	}
+}
+
+double FilterParam::judge_stability_even(const double* coef) const
+{
+	double penalty = 0.0;
+
+	for (unsigned int n = n_order + 1; n < this->opt_order(); n += 2)
+	{
+		if(abs(coef[n+1]) >= 1 || coef[n+1] <= abs(coef[n]) - 1)
+		{
+			penalty += coef[n]*coef[n] + coef[n+1]*coef[n+1];
+		}
+	}
+	return penalty;
+}
+
+double FilterParam::judge_stability_odd(const double* coef) const
+{
+	double penalty = 0.0;
+	
+	if(abs(coef[n_order + 1]) >= 1)
+	{
+    	penalty += coef[n_order + 1]*coef[n_order + 1];
+	}
+	for(unsigned int m = n_order + 2; m < opt_order(); m += 2)
+	{
+		if(abs(coef[m + 1]) >= 1 || coef[m + 1] <= abs(coef[m]) - 1)
+		{
+			penalty += coef[m]*coef[m] + coef[m + 1]*coef[m + 1];
+		}
+	}
+
+	return penalty;
+}
+
+/* # フィルタ構造体
+ *   ペナルティ関数法による目的関数値を計算する
+ *
+ */
+double FilterParam::evaluate(const vector<double> &coef) const
+{
+	if (coef.size() != opt_order())
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, coef.size(), opt_order());
+		exit(EXIT_FAILURE);
+	}
+
+	return evaluate_kernel(coef.data());
+}
+
+vector<double> FilterParam::stable_to_coef(const vector<double>& param) const
+{
+	if (param.size() != opt_order())
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of parameter is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, param.size(), opt_order());
+		exit(EXIT_FAILURE);
+	}
+
+	vector<double> coef(opt_order());
+	stable_to_coef(param.data(), coef.data());
+	return coef;
+}
+
+/* # フィルタ構造体
+ *   安定化変数から係数列への写像(連続領域版)
+ *   2次節は b2 - (|b1| - 1) >= (1 - r)^2 >= (1 - ρ)^2 となり，
+ *   半径が上限に丸められても安定三角形の境界に乗らない
+ */
+void FilterParam::stable_to_coef(const double* param, double* coef) const
+{
+	unsigned int m = n_order + 1;
+	for (unsigned int i = 0; i < m; ++i)
+	{
+		coef[i] = param[i];
+	}
+	if ((m_order % 2) == 1)
+	{
+		coef[m] = stable_radius*tanh(param[m]);
+		++m;
+	}
+	for (; m < opt_order(); m += 2)
+	{
+		const double r = stable_radius/(1.0 + exp(-param[m + 1]));
+		coef[m] = -2.0*r*cos(param[m]);
+		coef[m + 1] = r*r;
+	}
+}
+
+vector<double> FilterParam::coef_to_stable(const vector<double>& coef) const
+{
+	if (coef.size() != opt_order())
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, coef.size(), opt_order());
+		exit(EXIT_FAILURE);
+	}
+
+	vector<double> param(opt_order());
+	coef_to_stable(coef.data(), param.data());
+	return param;
+}
+
+/* # フィルタ構造体
+ *   係数列から安定化変数への写像(連続領域版)
+ *   逆写像が有限になるよう，tanhの値と半径の比を(-1, 1)の内側に制限する
+ *   実数極の組(b1^2 > 4 b2)は，半径sqrt(|b2|)の複素共役極の組に射影する
+ */
+void FilterParam::coef_to_stable(const double* coef, double* param) const
+{
+	constexpr double limit = 1.0 - 1.0e-12;
+	auto clamp_atanh = [&](double x)
+	{
+		return atanh(max(-limit, min(limit, x)));
+	};
+
+	unsigned int m = n_order + 1;
+	for (unsigned int i = 0; i < m; ++i)
+	{
+		param[i] = coef[i];
+	}
+	if ((m_order % 2) == 1)
+	{
+		param[m] = clamp_atanh(coef[m]/stable_radius);
+		++m;
+	}
+	for (; m < opt_order(); m += 2)
+	{
+		const double r = max(1.0e-12, min(limit, sqrt(abs(coef[m + 1]))/stable_radius));
+		param[m + 1] = log(r/(1.0 - r));
+		param[m] = acos(max(-1.0, min(1.0, -coef[m]/(2.0*stable_radius*r))));
+	}
+}
+
+/* # フィルタ構造体
+ *   安定化変数による目的関数値の計算
+ *   stable_to_coefで写した係数列のevaluateと同じ値になる
+ *   写した係数列は常に安定なため，安定性のペナルティは0となる
+ *   写像の結果はスレッドごとの作業領域に置き，ヒープ確保は初回のみ
+ *
+ * # 引数
+ * vector<double>& param : 安定化変数
+ * # 返り値
+ * double value : 目的関数値
+ */
+double FilterParam::evaluate_stable(const vector<double>& param) const
+{
+	if (param.size() != opt_order())
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of parameter is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, param.size(), opt_order());
+		exit(EXIT_FAILURE);
+	}
+
+	FilterWorkspace& ws = local_workspace();
+	if (ws.coef.size() < opt_order())
+	{
+		ws.coef.resize(opt_order());
+	}
+	stable_to_coef(param.data(), ws.coef.data());
+	return evaluate_kernel(ws.coef.data());
+}
+
+/* # フィルタ構造体
+ *   安定化変数による複数の候補解の目的関数値をまとめて計算する
+ *   全候補を作業領域の係数列の行列へ写してからevaluate_batchで評価する
+ *
+ * # 引数
+ * double* params : 安定化変数を行とする行列(ncand行 x opt_order()列，行優先で連続)
+ * unsigned int ncand : 候補解の数
+ * double* values : 目的関数値の出力先(ncand要素)
+ */
+void FilterParam::evaluate_stable_batch(const double* params, const unsigned int ncand, double* values) const
+{
+	const unsigned int order = opt_order();
+	FilterWorkspace& ws = local_workspace();
+	if (ws.coef.size() < (size_t)ncand*order)
+	{
+		ws.coef.resize((size_t)ncand*order);
+	}
+	for (unsigned int k = 0; k < ncand; ++k)
+	{
+		stable_to_coef(params + (size_t)k*order, ws.coef.data() + (size_t)k*order);
+	}
+	evaluate_batch(ws.coef.data(), ncand, values);
+}
+
+/* # フィルタ構造体
+ *   安定化変数による複数の候補解の目的関数値をスレッドプールで並列に計算する
+ *   チャンクの分け方はevaluate_batch_parallelと同じ
+ *
+ * # 引数
+ * double* params : 安定化変数を行とする行列(ncand行 x opt_order()列，行優先で連続)
+ * unsigned int ncand : 候補解の数
+ * double* values : 目的関数値の出力先(ncand要素)
+ * ThreadPool& pool : 使用するスレッドプール(省略時はプロセス共有のプール)
+ */
+void FilterParam::evaluate_stable_batch_parallel
+(const double* params, const unsigned int ncand, double* values, ThreadPool& pool) const
+{
+	unsigned int grain = max(1u, min(16u, ncand / (4*pool.size())));
+	if (use_candidate_lanes())
+	{
+		grain = (grain + SimdNative::width - 1) / SimdNative::width * SimdNative::width;
+	}
+	pool.parallel_for(0, ncand, grain,
+		[&](unsigned int begin, unsigned int end)
+		{
+			evaluate_stable_batch(params + (size_t)begin*opt_order(), end - begin, values + begin);
+		});
+}
+
+/* # フィルタ構造体
+ *   打ち切り付きの目的関数値の計算
+ *   周波数点を順に調べ，途中までの最大誤差とペナルティの和が
+ *   boundを超えた時点で計算を打ち切る
+ *   調べる順序はスレッドごとの作業領域に保持し，過去の候補で
+ *   誤差が大きかった周波数点から調べる
+ *
+ * # 引数
+ * vector<double>& coef : 係数列
+ * double bound : 打ち切りの閾値(現在の最良値など)
+ * # 返り値
+ * double value : bound以下の場合はevaluateと同じ目的関数値
+ *                boundを超えた場合は打ち切り時点の値(真の値の下界)
+ */
+double FilterParam::evaluate_bounded(const vector<double>& coef, const double bound) const
+{
+	return evaluate_bounded(coef, bound, local_workspace().order);
+}
+
+/* # フィルタ構造体
+ *   打ち切り付きの目的関数値の計算(順序指定版)
+ *   orderが別の周波数グリッドのものであれば作り直す
+ */
+double FilterParam::evaluate_bounded(const vector<double>& coef, const double bound, EvalOrder& order) const
+{
+	if (coef.size() != opt_order())
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, coef.size(), opt_order());
+		exit(EXIT_FAILURE);
+	}
+
+	if (!order.match(grid))
+	{
+		order.reset(grid);
+	}
+
+	double max_error = 0.0;	//最大誤差
+	double max_riple = 0.0;	//振幅隆起のペナルティの値
+	double max_gd = 0.0;	//通過域の群遅延の最大偏差(EvalMode::GroupDelay)
+
+	const double penalty = stability_weight*judge_stability(coef.data());
+	double value = penalty;
+	if (value > bound)
+	{
+		return value;
+	}
+
+	for (unsigned int k = 0; k < order.order.size(); ++k)
+	{
+		const unsigned int b = order.order[k];
+		double block_value = 0.0;
+
+		switch (order.type[b])
+		{
+			case BandType::Pass:
+			{
+				if (eval_mode == EvalMode::GroupDelay)
+				{
+					double block_gd = 0.0;
+					error_gd_kernel(coef.data(), order.begin[b], order.end[b], block_value, block_gd);
+					max_error = max(max_error, block_value);
+					max_gd = max(max_gd, block_gd);
+					block_value += group_delay_weight*block_gd;
+					break;
+				}
+				if (eval_mode == EvalMode::Magnitude)
+				{
+					error_mag_kernel(coef.data(), order.begin[b], order.end[b], block_value);
+				}
+				else
+				{
+					error_kernel(coef.data(), order.begin[b], order.end[b], block_value);
+				}
+				max_error = max(max_error, block_value);
+				break;
+			}
+			case BandType::Stop:
+			{
+				if (eval_mode == EvalMode::Magnitude)
+				{
+					error_mag_kernel(coef.data(), order.begin[b], order.end[b], block_value);
+				}
+				else
+				{
+					error_kernel(coef.data(), order.begin[b], order.end[b], block_value);
+				}
+				max_error = max(max_error, block_value);
+				break;
+			}
+			case BandType::Transition:
+			{
+				if (eval_mode == EvalMode::Magnitude)
+				{
+					riple_mag_kernel(coef.data(), order.begin[b], order.end[b], block_value);
+				}
+				else
+				{
+					riple_kernel(coef.data(), order.begin[b], order.end[b], block_value);
+				}
+				max_riple = max(max_riple, block_value);
+				block_value = riple_weight*block_value*block_value;
+				break;
+			}
+		}
+		order.update(b, block_value);
+
+		value = max_error + group_delay_weight*max_gd + riple_weight*max_riple*max_riple + penalty;
+		if (value > bound)
+		{
+			break;
+		}
+	}
+	order.sort();
+
+	return value;
+}
+
+/* # フィルタ構造体
+ *   複数の係数列(候補解)の目的関数値をまとめて計算する
+ *   周波数グリッドを全候補で共有し，候補ごとのヒープ確保は行わない
+ *   use_candidate_lanes()がtrueのときはSimdNative::width個ずつ候補解方向にSIMD化し，
+ *   端数の候補はevaluateと同じく1つずつ計算する
+ *   BatchLayout::Frequency(デフォルト)では，各候補の値はevaluateを1つずつ呼んだ場合と一致する
+ *   BatchLayout::Auto・Candidateで候補解方向が選ばれた場合は，
+ *   演算順序の違いによりevaluateと相対誤差1e-15程度の差が出る
+ *
+ * # 引数
+ * double* coefs : 係数列を行とする行列(ncand行 x opt_order()列，行優先で連続)
+ * unsigned int ncand : 候補解の数
+ * double* values : 目的関数値の出力先(ncand要素)
+ */
+void FilterParam::evaluate_batch(const double* coefs, const unsigned int ncand, double* values) const
+{
+	const unsigned int width = SimdNative::width;
+	const unsigned int order = opt_order();
+	unsigned int k = 0;
+	if (use_candidate_lanes())
+	{
+		// width個ずつAoSoAに並べ替えて候補解方向に評価する
+		// lanesの後ろ3*width*order要素はcascade_eval_mag_lanesの作業領域
+		FilterWorkspace& ws = local_workspace();
+		if (ws.lanes.size() < 4*width*order)
+		{
+			ws.lanes.resize(4*width*order);
+		}
+		for (; k + width <= ncand; k += width)
+		{
+			const double* group = coefs + (size_t)k*order;
+			for (unsigned int l = 0; l < width; ++l)
+			{
+				for (unsigned int i = 0; i < order; ++i)
+				{
+					ws.lanes[i*width + l] = group[(size_t)l*order + i];
+				}
+			}
+			evaluate_lanes(ws.lanes.data(), group, values + k);
+		}
+	}
+	for (; k < ncand; ++k)
+	{
+		values[k] = evaluate_kernel(coefs + (size_t)k*order);
+	}
+}
+
+/* # フィルタ構造体
+ *   複数の係数列(候補解)の目的関数値をまとめて計算する
+ *
+ * # 引数
+ * vector<double>& coefs : 係数列を行優先で連結した行列(要素数はopt_order()の倍数)
+ * vector<double>& values : 目的関数値の出力先(候補解の数に合わせてリサイズされる)
+ */
+void FilterParam::evaluate_batch(const vector<double>& coefs, vector<double>& values) const
+{
+	if (coefs.size() % opt_order() != 0)
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient matrix is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, coefs.size(), opt_order());
+		exit(EXIT_FAILURE);
+	}
+
+	const unsigned int ncand = coefs.size() / opt_order();
+	values.resize(ncand);
+	evaluate_batch(coefs.data(), ncand, values.data());
+}
+
+/* # フィルタ構造体
+ *   複数の係数列(候補解)の目的関数値をスレッドプールで並列に計算する
+ *   各候補の値はevaluate_batchと同一
+ *
+ * # 引数
+ * double* coefs : 係数列を行とする行列(ncand行 x opt_order()列，行優先で連続)
+ * unsigned int ncand : 候補解の数
+ * double* values : 目的関数値の出力先(ncand要素)
+ * ThreadPool& pool : 使用するスレッドプール(省略時はプロセス共有のプール)
+ */
+void FilterParam::evaluate_batch_parallel
+(const double* coefs, const unsigned int ncand, double* values, ThreadPool& pool) const
+{
+	// 1チャンクあたり数候補とし，スレッド間の受け渡し回数を抑える
+	// 候補解方向の評価ではチャンクをSIMD幅の倍数にしてレーンの余りを出さない
+	unsigned int grain = max(1u, min(16u, ncand / (4*pool.size())));
+	if (use_candidate_lanes())
+	{
+		grain = (grain + SimdNative::width - 1) / SimdNative::width * SimdNative::width;
+	}
+	pool.parallel_for(0, ncand, grain,
+		[&](unsigned int begin, unsigned int end)
+		{
+			evaluate_batch(coefs + (size_t)begin*opt_order(), end - begin, values + begin);
+		});
+}
+
+/* # フィルタ構造体
+ *   複数の係数列(候補解)の目的関数値をスレッドプールで並列に計算する
+ *
+ * # 引数
+ * vector<double>& coefs : 係数列を行優先で連結した行列(要素数はopt_order()の倍数)
+ * vector<double>& values : 目的関数値の出力先(候補解の数に合わせてリサイズされる)
+ * ThreadPool& pool : 使用するスレッドプール(省略時はプロセス共有のプール)
+ */
+void FilterParam::evaluate_batch_parallel
+(const vector<double>& coefs, vector<double>& values, ThreadPool& pool) const
+{
+	if (coefs.size() % opt_order() != 0)
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient matrix is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, coefs.size(), opt_order());
+		exit(EXIT_FAILURE);
+	}
+
+	const unsigned int ncand = coefs.size() / opt_order();
+	values.resize(ncand);
+	evaluate_batch_parallel(coefs.data(), ncand, values.data(), pool);
+}
+
+/* # フィルタ構造体
+ *   evaluate_batchを候補解方向のSIMD化で行うかを判定する
+ *   BatchLayout::Autoでは，1候補あたりの処理量を節のSIMD反復の回数で見積もって比べる
+ *     周波数点方向 : 節数 x (帯域ごとの 点数/幅 + 端に余るレーンのスカラー処理)
+ *                    + 帯域数 x 帯域ごとの固定の処理量
+ *     候補解方向 : 節数 x 点数/幅 x (1 + 係数ロードの割高分) + 帯域数 x 固定の処理量/幅
+ *   次数が低いほど帯域ごとの固定の処理量が効き，幅個の候補で分け合う候補解方向が有利になる
+ *   次数が高いと節ごとの反復が支配的になり，端数のスカラー処理と係数ロードの割高分の比較になる
+ *   係数ロードの割高分は，節あたりの演算が少ない振幅2乗カーネル(EvalMode::Magnitude)で小さい
+ */
+bool FilterParam::use_candidate_lanes() const
+{
+	const unsigned int width = SimdNative::width;
+	if (width == 1 || eval_mode == EvalMode::GroupDelay || batch_layout == BatchLayout::Frequency)
+	{
+		return false;
+	}
+	if (batch_layout == BatchLayout::Candidate)
+	{
+		return true;
+	}
+
+	const double nsection = (n_order + 1)/2 + (m_order + 1)/2;
+	const double overhead = eval_mode == EvalMode::Magnitude ?
+		candidate_lane_overhead_mag : candidate_lane_overhead;
+
+	double freq_iteration = 0.0;
+	for (unsigned int i = 0; i < grid.nband(); ++i)
+	{
+		freq_iteration += grid.band_size(i)/width + grid.band_size(i)%width;
+	}
+	const double freq_cost = nsection*freq_iteration + grid.nband()*band_setup_cost;
+	const double lane_cost = nsection*grid.size()/width*(1.0 + overhead)
+		+ grid.nband()*band_setup_cost/width;
+	return lane_cost < freq_cost;
+}
+
+/* # フィルタ構造体
+ *   AoSoAに並べたSimdNative::width個の候補解の目的関数値を計算する
+ *   EvalMode::ComplexとEvalMode::Magnitudeに対応する
+ *
+ * # 引数
+ * double* lanes : 係数をlanes[i*width + l](候補解lの係数i)に並べた配列
+ *                 続く3*width*opt_order()要素を作業領域として使う
+ * double* coefs : 元の係数列の行列(安定性の判別に使う，width行 x opt_order()列)
+ * double* values : 目的関数値の出力先(width要素)
+ */
+void FilterParam::evaluate_lanes(double* lanes, const double* coefs, double* values) const
+{
+	alignas(64) double max_error[SimdNative::width];
+	alignas(64) double max_riple[SimdNative::width];
+	double* work = lanes + SimdNative::width*opt_order();
+
+	if (eval_mode == EvalMode::Magnitude)
+	{
+		switch (cascade_type)
+		{
+			case CascadeType::SE:
+				cascade_eval_mag_lanes<false, false>(lanes, n_order, m_order, grid, threshold_riple, work, max_error, max_riple);
+				break;
+			case CascadeType::SO:
+				cascade_eval_mag_lanes<true, true>(lanes, n_order, m_order, grid, threshold_riple, work, max_error, max_riple);
+				break;
+			case CascadeType::NO:
+				cascade_eval_mag_lanes<true, false>(lanes, n_order, m_order, grid, threshold_riple, work, max_error, max_riple);
+				break;
+			case CascadeType::MO:
+				cascade_eval_mag_lanes<false, true>(lanes, n_order, m_order, grid, threshold_riple, work, max_error, max_riple);
+				break;
+		}
+	}
+	else
+	{
+		switch (cascade_type)
+		{
+			case CascadeType::SE:
+				cascade_eval_lanes<false, false>(lanes, n_order, m_order, grid, threshold_riple, max_error, max_riple);
+				break;
+			case CascadeType::SO:
+				cascade_eval_lanes<true, true>(lanes, n_order, m_order, grid, threshold_riple, max_error, max_riple);
+				break;
+			case CascadeType::NO:
+				cascade_eval_lanes<true, false>(lanes, n_order, m_order, grid, threshold_riple, max_error, max_riple);
+				break;
+			case CascadeType::MO:
+				cascade_eval_lanes<false, true>(lanes, n_order, m_order, grid, threshold_riple, max_error, max_riple);
+				break;
+		}
+	}
+
+	for (unsigned int l = 0; l < SimdNative::width; ++l)
+	{
+		const double penalty_stability = judge_stability(coefs + (size_t)l*opt_order());
+		values[l] = objective(max_error[l], max_riple[l], 0.0, penalty_stability);
+	}
+}
+
+/* # フィルタ構造体
+ *   目的関数値の計算本体
+ *   周波数特性の計算と最大誤差・振幅隆起の更新を1回の走査で行い，
+ *   周波数特性の配列は作らない
+ *   EvalMode::GroupDelayでは通過域の群遅延偏差も同じ走査で求め，
+ *   group_delay_weight倍して加える
+ *   EvalMode::Magnitudeでは振幅2乗特性の実数演算カーネルで振幅誤差を求める
+ */
+double FilterParam::evaluate_kernel(const double* coef) const
+{
+	double max_error = 0.0;	//最大誤差
+	double max_riple = 0.0;	//振幅隆起のペナルティの値
+	double max_gd = 0.0;	//通過域の群遅延の最大偏差(EvalMode::GroupDelay)
+
+	double penalty_stability = judge_stability(coef);
+	if (eval_mode == EvalMode::GroupDelay)
+	{
+		if (fixed_order)
+		{
+			kernels.eval_gd(coef, n_order, m_order, grid, threshold_riple, group_delay, max_error, max_riple, max_gd);
+		}
+		else
+		{
+			switch (cascade_type)
+			{
+				case CascadeType::SE:
+					cascade_eval_gd<DynamicOrder<false, false>>(coef, n_order, m_order, grid, threshold_riple, group_delay, max_error, max_riple, max_gd);
+					break;
+				case CascadeType::SO:
+					cascade_eval_gd<DynamicOrder<true, true>>(coef, n_order, m_order, grid, threshold_riple, group_delay, max_error, max_riple, max_gd);
+					break;
+				case CascadeType::NO:
+					cascade_eval_gd<DynamicOrder<true, false>>(coef, n_order, m_order, grid, threshold_riple, group_delay, max_error, max_riple, max_gd);
+					break;
+				case CascadeType::MO:
+					cascade_eval_gd<DynamicOrder<false, true>>(coef, n_order, m_order, grid, threshold_riple, group_delay, max_error, max_riple, max_gd);
+					break;
+			}
+		}
+	}
+	else if (eval_mode == EvalMode::Magnitude)
+	{
+		if (fixed_order)
+		{
+			kernels.eval_mag(coef, n_order, m_order, grid, threshold_riple, max_error, max_riple);
+		}
+		else
+		{
+			switch (cascade_type)
+			{
+				case CascadeType::SE:
+					cascade_eval_mag<DynamicOrder<false, false>>(coef, n_order, m_order, grid, threshold_riple, max_error, max_riple);
+					break;
+				case CascadeType::SO:
+					cascade_eval_mag<DynamicOrder<true, true>>(coef, n_order, m_order, grid, threshold_riple, max_error, max_riple);
+					break;
+				case CascadeType::NO:
+					cascade_eval_mag<DynamicOrder<true, false>>(coef, n_order, m_order, grid, threshold_riple, max_error, max_riple);
+					break;
+				case CascadeType::MO:
+					cascade_eval_mag<DynamicOrder<false, true>>(coef, n_order, m_order, grid, threshold_riple, max_error, max_riple);
+					break;
+			}
+		}
+	}
+	else if (fixed_order)
+	{
+		kernels.eval(coef, n_order, m_order, grid, threshold_riple, max_error, max_riple);
+	}
+	else
+	{
+		switch (cascade_type)
+		{
+			case CascadeType::SE:
+				cascade_eval<DynamicOrder<false, false>>(coef, n_order, m_order, grid, threshold_riple, max_error, max_riple);
+				break;
+			case CascadeType::SO:
+				cascade_eval<DynamicOrder<true, true>>(coef, n_order, m_order, grid, threshold_riple, max_error, max_riple);
+				break;
+			case CascadeType::NO:
+				cascade_eval<DynamicOrder<true, false>>(coef, n_order, m_order, grid, threshold_riple, max_error, max_riple);
+				break;
+			case CascadeType::MO:
+				cascade_eval<DynamicOrder<false, true>>(coef, n_order, m_order, grid, threshold_riple, max_error, max_riple);
+				break;
+		}
+	}
+
+	return objective(max_error, max_riple, max_gd, penalty_stability);
+}
+
+/* # フィルタ構造体
+ *   最大誤差・振幅隆起・群遅延偏差・安定性のペナルティから目的関数値を組み立てる
+ *   evaluateと同じ重みを使うため，外部の評価器(IncrementalEvaluator等)もこれを使う
+ *
+ * # 引数
+ * double max_error : 通過域・阻止域の最大誤差
+ * double max_riple : 遷移域の最大振幅隆起(閾値以下なら0)
+ * double max_gd : 通過域の群遅延の最大偏差(EvalMode::GroupDelay以外では0)
+ * double stability : judge_stabilityの値
+ */
+double FilterParam::objective
+(const double max_error, const double max_riple, const double max_gd, const double stability) const
+{
+	return max_error + group_delay_weight*max_gd + riple_weight*max_riple*max_riple + stability_weight*stability;
+}
+
+double FilterParam::smooth_objective(const vector<double>& coef, const unsigned int log2p, vector<double>& grad) const
+{
+	if (coef.size() != opt_order())
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, coef.size(), opt_order());
+		exit(EXIT_FAILURE);
+	}
+
+	grad.resize(opt_order());
+	return smooth_objective(coef.data(), log2p, grad.data());
+}
+
+/* # フィルタ構造体
+ *   滑らかな目的関数と勾配の計算本体
+ *   cascade_smoothで累積値を求め，ノルムと勾配を仕上げる
+ *     ||u||_p = M (Σ r^p / P)^(1/p)，∂||u||_p = (Σ r^p / P)^(1/p - 1) Σ r^(p-1) ∂u / P (r = u/M)
+ *   安定性のペナルティの勾配は，安定三角形の外にある節の係数c1, c2について2 c1, 2 c2
+ */
+double FilterParam::smooth_objective(const double* coef, const unsigned int log2p, double* grad) const
+{
+	if (log2p < 1 || log2p > 30)
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Order of norm is illegal.(log2p : %u)\n",
+			__FILE__, __LINE__, log2p);
+		exit(EXIT_FAILURE);
+	}
+
+	const unsigned int nopt = opt_order();
+	const unsigned int width = SimdNative::width;
+	const double p = (double)(1u << log2p);
+
+	// 節の値(2 x nopt x width)，誤差と振幅隆起の累積値((1 + nopt) x width ずつ)
+	FilterWorkspace& ws = local_workspace();
+	const size_t nsec = 2*(size_t)nopt*width;
+	const size_t nacc = (1 + (size_t)nopt)*width;
+	if (ws.smooth.size() < nsec + 2*nacc)
+	{
+		ws.smooth.resize(nsec + 2*nacc);
+	}
+	double* sec = ws.smooth.data();
+	fill(sec + nsec, sec + nsec + 2*nacc, 0.0);
+	SmoothNorm error = {0.0, 0, sec + nsec, sec + nsec + width};
+	SmoothNorm riple = {0.0, 0, sec + nsec + nacc, sec + nsec + nacc + width};
+
+	switch (cascade_type)
+	{
+		case CascadeType::SE:
+			cascade_smooth<false, false>(coef, n_order, m_order, grid, threshold_riple, log2p, sec, error, riple);
+			break;
+		case CascadeType::SO:
+			cascade_smooth<true, true>(coef, n_order, m_order, grid, threshold_riple, log2p, sec, error, riple);
+			break;
+		case CascadeType::NO:
+			cascade_smooth<true, false>(coef, n_order, m_order, grid, threshold_riple, log2p, sec, error, riple);
+			break;
+		case CascadeType::MO:
+			cascade_smooth<false, true>(coef, n_order, m_order, grid, threshold_riple, log2p, sec, error, riple);
+			break;
+	}
+
+	// ノルムの値と，その勾配をweight倍してgradに加える処理
+	auto lane_sum = [width](const double* lanes) -> double
+	{
+		double sum = 0.0;
+		for (unsigned int l = 0; l < width; ++l)
+		{
+			sum += lanes[l];
+		}
+		return sum;
+	};
+	auto norm = [&](const SmoothNorm& acc) -> double
+	{
+		if (acc.scale == 0.0)
+		{
+			return 0.0;
+		}
+		return acc.scale*pow(lane_sum(acc.sum)/acc.npoint, 1.0/p);
+	};
+	auto add_grad = [&](const SmoothNorm& acc, const double weight)
+	{
+		if (acc.scale == 0.0)
+		{
+			return;
+		}
+		const double factor = weight*pow(lane_sum(acc.sum)/acc.npoint, 1.0/p - 1.0)/acc.npoint;
+		for (unsigned int k = 0; k < nopt; ++k)
+		{
+			grad[k] += factor*lane_sum(acc.grad + k*width);
+		}
+	};
+
+	// riple_weight R^2 の勾配は 2 riple_weight R ∂R
+	fill(grad, grad + nopt, 0.0);
+	const double norm_error = norm(error);
+	const double norm_riple = norm(riple);
+	add_grad(error, 1.0);
+	add_grad(riple, 2.0*riple_weight*norm_riple);
+
+	// 安定性のペナルティ(judge_stability_even/oddと同じ判定)
+	const double stability = judge_stability(coef);
+	if (stability > 0.0)
+	{
+		unsigned int m = n_order + 1;
+		if (cascade_type == CascadeType::SO || cascade_type == CascadeType::MO)
+		{
+			if (abs(coef[m]) >= 1)
+			{
+				grad[m] += 2.0*stability_weight*coef[m];
+			}
+			m += 1;
+		}
+		for (; m < nopt; m += 2)
+		{
+			if (abs(coef[m + 1]) >= 1 || coef[m + 1] <= abs(coef[m]) - 1)
+			{
+				grad[m] += 2.0*stability_weight*coef[m];
+				grad[m + 1] += 2.0*stability_weight*coef[m + 1];
+			}
+		}
+	}
+
+	return norm_error + riple_weight*norm_riple*norm_riple + stability_weight*stability;
+}
+
+vector<double> FilterParam::init_coef(const double a0, const double a, const double b) const
+{
+	thread_local random_device rnd;
+	thread_local mt19937 mt(rnd());
+	return init_coef(a0, a, b, mt);
+}
+
+/* # フィルタ構造体
+ *   係数列の初期値を一様乱数で生成する(乱数生成器を与える版)
+ *   最適化器がシード値から同じ初期集団を再現するために使う
+ */
+vector<double> FilterParam::init_coef(const double a0, const double a, const double b, mt19937& mt) const
+{
+	uniform_real_distribution<> a0_range(-abs(a0), abs(a0));
+	uniform_real_distribution<> a_range(-abs(a), abs(a));
+	uniform_real_distribution<> b_range(-abs(b), abs(b));
+
+	vector<double> coef;
+		coef.reserve(this->opt_order());
+
+	coef.emplace_back(a0_range(mt));
+	for (unsigned int n = 0; n < n_order; ++n)
+	{
+		coef.emplace_back(a_range(mt));
+	}
+	for (unsigned int m = 0; m < m_order; ++m)
+	{
+		coef.emplace_back(b_range(mt));
+	}
+
+	return coef;
+}
+
+vector<double> FilterParam::init_stable_coef(const double a0, const double a) const
+{
+	thread_local random_device rnd;
+	thread_local mt19937 mt(rnd());
+	return init_stable_coef(a0, a, mt);
+}
+
+/* # フィルタ構造体
+ *   安定な係数列の初期値を一様乱数で生成する(乱数生成器を与える版)
+ */
+vector<double> FilterParam::init_stable_coef(const double a0, const double a, mt19937& mt) const
 {
-	thread_local random_device rnd;
-	thread_local mt19937 mt(rnd());
 	uniform_real_distribution<> a0_range(-abs(a0), abs(a0));
 	uniform_real_distribution<> a_range(-abs(a), abs(a));
 	uniform_real_distribution<> uniform(-1.0 + numeric_limits<double>::epsilon(), 1.0);
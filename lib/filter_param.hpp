@@ -17,6 +17,7 @@
 #include <cstdlib>
 #include <cmath>
 #include <ctime>
+#include <cstdint>
 
 #include <iostream>
 #include <fstream>
@@ -25,9 +26,10 @@
 #include <string>
 #include <regex>
 #include <complex>
-#include <functional>
 #include <random>
 
+#include "thread_pool.hpp"
+
 using namespace std;
 
 template <typename... Args>
@@ -57,6 +59,35 @@ enum class BandType
 	Transition
 };
 
+/* 目的関数(evaluate)の評価方式を示す列挙体
+ *   Complex : 複素誤差|D - H|の最大値(従来の評価)
+ *   GroupDelay : 複素誤差に加え，通過域の群遅延と所望群遅延の差の最大値に
+ *                重みを掛けた項を加える(同じ周波数点の走査で計算)
+ *   Magnitude : 振幅誤差||D| - |H||の最大値(位相は評価しない)
+ *               実数演算のみの振幅2乗特性カーネルで計算する
+ */
+enum class EvalMode
+{
+	Complex,
+	GroupDelay,
+	Magnitude
+};
+
+/* 候補解をまとめて評価する(evaluate_batch)ときのSIMD化の方向を示す列挙体
+ *   Auto : 次数・評価方式・周波数点数から速い方を選ぶ
+ *   Frequency : 周波数点方向(候補解を1つずつevaluateと同じカーネルで評価)
+ *               値はevaluateと一致する
+ *   Candidate : 候補解方向(SimdNative::width個の候補解を1つのレジスタに並べて評価)
+ *               演算順序が異なるため，evaluateと相対誤差1e-15程度の差が出る
+ *               EvalMode::GroupDelayでは使えず，Frequencyとして扱う
+ */
+enum class BatchLayout
+{
+	Auto,
+	Frequency,
+	Candidate
+};
+
 /* バンド(周波数帯域)の情報をまとめた構造体
  *   type : 帯域の種類(通過・阻止・遷移)
  *   left : 帯域の左端正規化周波数 [0:0.5)
@@ -99,6 +130,244 @@ public:
 	string sprint();
 };
 
+/* 境界整列(アライメント)付きアロケータ
+ *   SIMD命令でのロードを想定し，確保領域の先頭をAlignバイト境界に揃える
+ *   Alignは2の冪であること
+ */
+template <typename T, size_t Align = 64>
+struct AlignedAllocator
+{
+	typedef T value_type;
+
+	template <typename U>
+	struct rebind
+	{ typedef AlignedAllocator<U, Align> other; };
+
+	AlignedAllocator() {}
+	template <typename U>
+	AlignedAllocator(const AlignedAllocator<U, Align>&) {}
+
+	T* allocate(size_t n)
+	{
+		// 元の先頭アドレスを整列後アドレスの直前に保存しておく
+		void* raw = ::operator new(n*sizeof(T) + Align + sizeof(void*));
+		uintptr_t addr = reinterpret_cast<uintptr_t>(raw) + sizeof(void*);
+		addr = (addr + Align - 1) & ~(uintptr_t)(Align - 1);
+		reinterpret_cast<void**>(addr)[-1] = raw;
+		return reinterpret_cast<T*>(addr);
+	}
+	void deallocate(T* p, size_t)
+	{ ::operator delete(reinterpret_cast<void**>(p)[-1]); }
+};
+
+template <typename T, typename U, size_t Align>
+bool operator==(const AlignedAllocator<T, Align>&, const AlignedAllocator<U, Align>&)
+{ return true; }
+template <typename T, typename U, size_t Align>
+bool operator!=(const AlignedAllocator<T, Align>&, const AlignedAllocator<U, Align>&)
+{ return false; }
+
+template <typename T>
+using aligned_vector = vector<T, AlignedAllocator<T>>;
+
+/* 周波数グリッドの構造体
+ *   全帯域の周波数点を1本の連続した配列(Structure of Arrays)に並べて格納する
+ *   帯域iの周波数点は[band_offset[i] : band_offset[i + 1])の範囲
+ *
+ *   csw_re, csw_im : 複素正弦波e^-jωの実部・虚部
+ *   csw2_re, csw2_im : 複素正弦波e^-j2ωの実部・虚部
+ *   desire_re, desire_im : 所望特性の実部・虚部(遷移域では0)
+ *   desire_mag : 所望特性の振幅(遷移域では0，EvalMode::Magnitudeで使用)
+ *   band_type : 周波数点ごとの帯域の種類
+ *   band_offset : 帯域ごとの先頭インデックス(末尾に総点数を持つ)
+ */
+struct FreqGrid
+{
+	aligned_vector<double> csw_re;
+	aligned_vector<double> csw_im;
+	aligned_vector<double> csw2_re;
+	aligned_vector<double> csw2_im;
+	aligned_vector<double> desire_re;
+	aligned_vector<double> desire_im;
+	aligned_vector<double> desire_mag;
+	vector<BandType> band_type;
+	vector<unsigned int> band_offset;
+
+	FreqGrid()
+	: band_offset(1, 0)
+	{}
+
+	unsigned int size() const
+	{ return band_offset.back(); }
+	unsigned int nband() const
+	{ return band_offset.size() - 1; }
+	unsigned int band_begin(unsigned int i) const
+	{ return band_offset[i]; }
+	unsigned int band_end(unsigned int i) const
+	{ return band_offset[i + 1]; }
+	unsigned int band_size(unsigned int i) const
+	{ return band_offset[i + 1] - band_offset[i]; }
+};
+
+/* 周波数グリッドの[begin : end)の点の周波数特性を実部・虚部の配列に書き込むカーネル
+ *   (cascade_kernel.hppのcascade_res<Order>)
+ */
+typedef void (*CascadeResKernel)(const double*, const unsigned int, const unsigned int,
+	const FreqGrid&, const unsigned int, const unsigned int, double*, double*);
+
+/* 周波数グリッドの[begin : end)の点の群遅延を配列に書き込むカーネル
+ *   (cascade_kernel.hppのcascade_gd<Order>)
+ */
+typedef void (*CascadeGdKernel)(const double*, const unsigned int, const unsigned int,
+	const FreqGrid&, const unsigned int, const unsigned int, double*);
+
+/* 周波数グリッドの[begin : end)の点の周波数特性と群遅延を1回の走査で書き込むカーネル
+ *   (cascade_kernel.hppのcascade_res_gd<Order>)
+ */
+typedef void (*CascadeResGdKernel)(const double*, const unsigned int, const unsigned int,
+	const FreqGrid&, const unsigned int, const unsigned int, double*, double*, double*);
+
+/* 周波数特性を保存せずに最大誤差・最大振幅隆起を計算するカーネル
+ *   (cascade_kernel.hppのcascade_eval<Order>)
+ */
+typedef void (*CascadeEvalKernel)(const double*, const unsigned int, const unsigned int,
+	const FreqGrid&, const double, double&, double&);
+
+/* 周波数グリッドの[begin : end)の点の最大誤差・最大振幅隆起を更新するカーネル
+ *   (cascade_kernel.hppのcascade_error<Order>, cascade_riple<Order>)
+ */
+typedef void (*CascadeErrorKernel)(const double*, const unsigned int, const unsigned int,
+	const FreqGrid&, const unsigned int, const unsigned int, double&);
+typedef void (*CascadeRipleKernel)(const double*, const unsigned int, const unsigned int,
+	const FreqGrid&, const unsigned int, const unsigned int, const double, double&);
+
+/* 周波数グリッドの[begin : end)の点の振幅2乗特性|H|^2を配列に書き込むカーネル
+ *   (cascade_kernel.hppのcascade_power<Order>)
+ */
+typedef void (*CascadePowerKernel)(const double*, const unsigned int, const unsigned int,
+	const FreqGrid&, const unsigned int, const unsigned int, double*);
+
+/* 評価方式EvalMode::GroupDelayの評価カーネル
+ *   最大誤差・最大振幅隆起に加え，通過域の群遅延の最大偏差を計算する
+ *   (cascade_kernel.hppのcascade_eval_gd<Order>)
+ */
+typedef void (*CascadeEvalGdKernel)(const double*, const unsigned int, const unsigned int,
+	const FreqGrid&, const double, const double, double&, double&, double&);
+
+/* 周波数グリッドの[begin : end)の点の最大誤差と群遅延の最大偏差を更新するカーネル
+ *   (cascade_kernel.hppのcascade_error_gd<Order>)
+ */
+typedef void (*CascadeErrorGdKernel)(const double*, const unsigned int, const unsigned int,
+	const FreqGrid&, const unsigned int, const unsigned int, const double, double&, double&);
+
+/* 分子・分母次数の偶奇の組み合わせを示す列挙体
+ *   SE : 偶数次/偶数次
+ *   SO : 奇数次/奇数次
+ *   NO : 奇数次/偶数次(分子のみ奇数)
+ *   MO : 偶数次/奇数次(分母のみ奇数)
+ */
+enum class CascadeType
+{
+	SE,
+	SO,
+	NO,
+	MO
+};
+
+/* 次数を固定したカーネル(FixedOrder)の組
+ *   コンストラクタで次数に対応する表の要素を設定する
+ */
+struct CascadeKernels
+{
+	CascadeResKernel res;
+	CascadeGdKernel gd;
+	CascadeResGdKernel res_gd;
+	CascadeEvalKernel eval;
+	CascadeErrorKernel error;
+	CascadeRipleKernel riple;
+	CascadeEvalGdKernel eval_gd;
+	CascadeErrorGdKernel error_gd;
+	CascadePowerKernel power;
+	CascadeEvalKernel eval_mag;		// EvalMode::Magnitudeの評価(cascade_eval_mag<Order>)
+	CascadeErrorKernel error_mag;	// 振幅誤差(cascade_error_mag<Order>)
+	CascadeRipleKernel riple_mag;	// 実数演算の振幅隆起(cascade_riple_mag<Order>)
+
+	CascadeKernels()
+	: res(nullptr), gd(nullptr), res_gd(nullptr), eval(nullptr), error(nullptr), riple(nullptr),
+	  eval_gd(nullptr), error_gd(nullptr),
+	  power(nullptr), eval_mag(nullptr), error_mag(nullptr), riple_mag(nullptr)
+	{}
+};
+
+/* 打ち切り評価(evaluate_bounded)で周波数点を調べる順序
+ *   周波数グリッドを帯域をまたがないblock_size点ごとのブロックに分け，
+ *   過去の候補で誤差(遷移域では振幅隆起のペナルティ)が大きかった
+ *   ブロックから先に調べる
+ *
+ *   begin, end : ブロックの周波数点の範囲[begin : end)
+ *   type : ブロックの帯域の種類
+ *   score : ブロックごとの過去の誤差の指数移動平均
+ *   order : 調べる順に並べたブロック番号
+ *   band_offset : 生成元の周波数グリッドの帯域構造
+ */
+struct EvalOrder
+{
+	static constexpr unsigned int block_size = 16;
+	static constexpr double smoothing = 0.25;
+
+	vector<unsigned int> begin;
+	vector<unsigned int> end;
+	vector<BandType> type;
+	vector<double> score;
+	vector<unsigned int> order;
+	vector<unsigned int> band_offset;
+
+	bool match(const FreqGrid& grid) const
+	{ return band_offset == grid.band_offset; }
+	void reset(const FreqGrid&);
+	void update(const unsigned int, const double);
+	void sort();
+};
+
+/* 周波数特性・群遅延計算用の作業領域
+ *   呼び出し側で保持して使い回すことで，計算ごとのヒープ確保をなくす
+ *   reserveは必要な大きさより小さいときだけ確保し直す
+ *
+ *   re, im : 周波数特性の実部・虚部
+ *   gd : 群遅延
+ *   order : 打ち切り評価の順序
+ *   lanes : 候補解方向の評価でAoSoAに並べた係数
+ *   smooth : 滑らかな目的関数(smooth_objective)の節の値と累積値
+ */
+struct FilterWorkspace
+{
+	aligned_vector<double> re;
+	aligned_vector<double> im;
+	aligned_vector<double> gd;
+	EvalOrder order;
+	aligned_vector<double> lanes;
+	aligned_vector<double> smooth;
+	aligned_vector<double> coef;
+
+	void reserve(unsigned int npoint)
+	{
+		if (re.size() < npoint)
+		{
+			re.resize(npoint);
+			im.resize(npoint);
+			gd.resize(npoint);
+		}
+	}
+};
+
+/* フィルタパラメータ構造体
+ *   構築後の状態を変更しないconstメンバ関数(freq_res, group_delay_res,
+ *   judge_stability, evaluate, evaluate_bounded, evaluate_batch, init_coef等)は
+ *   複数スレッドから同一インスタンスに対して同時に呼び出してよい
+ *   作業領域と乱数生成器はスレッドごと(thread_local)に持つ
+ *   set_fixed_order等の非constメンバ関数は他の呼び出しと同時に行ってはならない
+ *   EvalOrderを引数に取るevaluate_boundedは，EvalOrderをスレッド間で共有しないこと
+ */
 struct FilterParam
 {
 protected:
@@ -111,37 +380,45 @@ protected:
 	unsigned int nsplit_transition;
 	double group_delay;
 	double threshold_riple;
+	EvalMode eval_mode;
+	double group_delay_weight;
+	BatchLayout batch_layout;
 
 	// 内部パラメータ
 	
-	vector<vector<complex<double>>> csw;			// 複素正弦波e^-jωを周波数帯域別に格納
-	vector<vector<complex<double>>> csw2;			// 複素正弦波e^-j2ωを周波数帯域別に格納
-	vector<vector<complex<double>>> desire_res;		// 所望特性の周波数特性
+	FreqGrid grid;		// 複素正弦波e^-jω, e^-j2ωと所望特性を全帯域で連続に格納
 
-	function< vector<vector<complex<double>>>(const FilterParam*, const vector<double>&) > freq_res_func;
-	function< vector<vector<double>>(const FilterParam*, const vector<double>&) > group_delay_func;
-	function< double(const FilterParam*, const vector<double>&) > stability_func;
+	CascadeType cascade_type;	// 次数の偶奇による使用するカーネルの分岐
+	CascadeKernels kernels;		// 次数固定カーネル(fixed_orderがtrueのとき使用)
+	bool fixed_order;
 
 	// 内部メソッド
 
 	FilterParam()
 	:n_order(0), m_order(0),
 	 nsplit_approx(0), nsplit_transition(0), group_delay(0.0),
-	 threshold_riple(1.0)
+	 threshold_riple(1.0), eval_mode(EvalMode::Complex), group_delay_weight(1.0),
+	 batch_layout(BatchLayout::Frequency),
+	 cascade_type(CascadeType::SE), fixed_order(false)
 	{}
 
-	vector<vector<complex<double>>> freq_res_se(const vector<double>&) const;
-	vector<vector<complex<double>>> freq_res_so(const vector<double> &) const;
-	vector<vector<complex<double>>> freq_res_no(const vector<double>&) const;
-	vector<vector<complex<double>>> freq_res_mo(const vector<double>&) const;
+	double judge_stability_even(const double*) const;
+	double judge_stability_odd(const double*) const;
+	double judge_stability(const double* coef) const
+	{
+		return (cascade_type == CascadeType::SO || cascade_type == CascadeType::MO) ?
+			judge_stability_odd(coef) : judge_stability_even(coef);
+	}
 
-	vector<vector<double>> group_delay_se(const vector<double> &) const;
-	vector<vector<double>> group_delay_so(const vector<double> &) const;
-	vector<vector<double>> group_delay_no(const vector<double> &) const;
-	vector<vector<double>> group_delay_mo(const vector<double> &) const;
+	void error_kernel(const double*, const unsigned int, const unsigned int, double&) const;
+	void riple_kernel(const double*, const unsigned int, const unsigned int, double&) const;
+	void error_gd_kernel(const double*, const unsigned int, const unsigned int, double&, double&) const;
+	void error_mag_kernel(const double*, const unsigned int, const unsigned int, double&) const;
+	void riple_mag_kernel(const double*, const unsigned int, const unsigned int, double&) const;
+	double evaluate_kernel(const double*) const;
+	void evaluate_lanes(double*, const double*, double*) const;
 
-	double judge_stability_even(const vector<double>&) const;
-	double judge_stability_odd(const vector<double>&) const;
+	static FilterWorkspace& local_workspace();
 
 public:
 	FilterParam(unsigned int, unsigned int, BandParam,
@@ -165,6 +442,18 @@ public:
 	{ return nsplit_transition; }
 	double gd() const
 	{ return group_delay; }
+	bool is_fixed_order() const
+	{ return fixed_order; }
+	const FreqGrid& freq_grid() const
+	{ return grid; }
+	double riple_threshold() const
+	{ return threshold_riple; }
+	EvalMode evaluation_mode() const
+	{ return eval_mode; }
+	double gd_weight() const
+	{ return group_delay_weight; }
+	BatchLayout batch_layout_mode() const
+	{ return batch_layout; }
 
 	// set function
 	/* # フィルタ構造体
@@ -174,6 +463,36 @@ public:
 	void set_threshold_riple(double input)
 	{ threshold_riple = input; }
 
+	/* # フィルタ構造体
+	 *   目的関数(evaluate)の評価方式を変更する
+	 *   デフォルト値はEvalMode::Complex
+	 */
+	void set_eval_mode(EvalMode input)
+	{ eval_mode = input; }
+
+	/* # フィルタ構造体
+	 *   EvalMode::GroupDelayで通過域の群遅延偏差に掛ける重みを変更する
+	 *   デフォルト値は1.0
+	 */
+	void set_gd_weight(double input)
+	{ group_delay_weight = input; }
+
+	/* # フィルタ構造体
+	 *   evaluate_batchのSIMD化の方向を変更する
+	 *   デフォルト値はBatchLayout::Frequency(evaluateと一致する値を返す)
+	 *   Autoにすると速い方を選ぶが，候補解方向ではevaluateと相対誤差1e-15程度の差が出る
+	 */
+	void set_batch_layout(BatchLayout input)
+	{ batch_layout = input; }
+
+	/* # フィルタ構造体
+	 *   次数固定カーネルの使用を切り替える
+	 *   trueでも次数固定カーネルが生成されていない次数では汎用カーネルを使う
+	 *   (生成する次数はcascade_kernel.hppのCASCADE_FIXED_ORDER_LISTを参照)
+	 *   デフォルト値はtrue
+	 */
+	void set_fixed_order(bool);
+
 	// normal function
 	/* # フィルタ構造体
 	 *   周波数特性計算関数
@@ -187,7 +506,25 @@ public:
 	 *   vector<vector<complex<double>>> response : 周波数帯域-周波数分割数の2重配列
 	 */
 	vector<vector<complex<double>>> freq_res(const vector<double>& coef) const
-	{ return this->freq_res_func(this, coef); }
+	{
+		vector<vector<complex<double>>> res;
+		freq_res(coef, res);
+		return res;
+	}
+
+	/* # フィルタ構造体
+	 *   周波数特性計算関数(確保済みの領域へ書き込む版)
+	 *   resは帯域構造に合わせてリサイズされるが，
+	 *   2回目以降に同じresを渡した場合はヒープ確保を行わない
+	 */
+	void freq_res(const vector<double>&, vector<vector<complex<double>>>&) const;
+
+	/* # フィルタ構造体
+	 *   周波数特性計算関数(連続領域版)
+	 *   周波数グリッドの全点(freq_grid().size()点)の実部・虚部を
+	 *   呼び出し側の配列re, imに書き込む。ヒープ確保は行わない
+	 */
+	void freq_res(const double*, double*, double*) const;
 	
 	/* # フィルタ構造体
 	 *   群遅延特性計算関数
@@ -201,7 +538,117 @@ public:
 	 *   vector<vector<double>> response : 周波数帯域-周波数分割数の2重配列
 	 */
 	vector<vector<double>> group_delay_res(const vector<double>& coef) const
-	{ return this->group_delay_func(this, coef); }
+	{
+		vector<vector<double>> res;
+		group_delay_res(coef, res);
+		return res;
+	}
+
+	/* # フィルタ構造体
+	 *   群遅延特性計算関数(確保済みの領域へ書き込む版)
+	 */
+	void group_delay_res(const vector<double>&, vector<vector<double>>&) const;
+
+	/* # フィルタ構造体
+	 *   群遅延特性計算関数(連続領域版)
+	 *   周波数グリッドの全点の群遅延を呼び出し側の配列gdに書き込む
+	 */
+	void group_delay_res(const double*, double*) const;
+
+	/* # フィルタ構造体
+	 *   周波数特性・群遅延特性の同時計算関数
+	 *   各節の 1 + c1 e^-jω + c2 e^-j2ω を1度だけ計算し，
+	 *   freq_resとgroup_delay_resを別々に呼ぶ場合の半分程度の走査で済ませる
+	 *   振幅・位相はresの絶対値・偏角として得られる
+	 *
+	 *   # 引数
+	 *   vector<double> coef : 係数列(a0, a1, a2[0], a2[1],..., b1, b2[0], b2[1],...)
+	 *   vector<vector<complex<double>>>& res : 周波数特性の出力(周波数帯域-周波数分割数の2重配列)
+	 *   vector<vector<double>>& gd : 群遅延特性の出力(周波数帯域-周波数分割数の2重配列)
+	 */
+	void freq_gd_res(const vector<double>&, vector<vector<complex<double>>>&, vector<vector<double>>&) const;
+
+	/* # フィルタ構造体
+	 *   周波数特性・群遅延特性の同時計算関数(連続領域版)
+	 *   周波数グリッドの全点の実部・虚部・群遅延を呼び出し側の配列re, im, gdに書き込む
+	 */
+	void freq_gd_res(const double*, double*, double*, double*) const;
+
+	/* # フィルタ構造体
+	 *   振幅2乗特性計算関数
+	 *   各節の|1 + c1 e^-jω + c2 e^-j2ω|^2 = 1 + c1^2 + c2^2 + 2 c1 (1 + c2) cosω + 2 c2 cos2ω
+	 *   を実数の多項式として計算し，複素数の乗除算を行わない
+	 *
+	 *   # 引数
+	 *   vector<double> coef : 係数列(a0, a1, a2[0], a2[1],..., b1, b2[0], b2[1],...)
+	 *   #返り値
+	 *   vector<vector<double>> response : |H|^2の周波数帯域-周波数分割数の2重配列
+	 */
+	vector<vector<double>> power_res(const vector<double>&) const;
+
+	/* # フィルタ構造体
+	 *   縦続型の係数列を分子・分母の多項式に展開する
+	 *     H(z) = (num[0] + num[1] z^-1 + ...) / (den[0] + den[1] z^-1 + ...)
+	 *   numはa0を掛けた値，den[0]は1
+	 *
+	 *   # 引数
+	 *   vector<double> coef : 係数列(a0, a1, a2[0], a2[1],..., b1, b2[0], b2[1],...)
+	 *   vector<double>& num : 分子多項式の係数(n_order + 1個)
+	 *   vector<double>& den : 分母多項式の係数(m_order + 1個)
+	 */
+	void expand_poly(const vector<double>&, vector<double>&, vector<double>&) const;
+
+	/* # フィルタ構造体
+	 *   一様な密グリッド上の周波数特性計算関数(検証用)
+	 *   縦続型のまま各点を直接計算する(O(P x N))
+	 *   誤差は最大振幅に対して1e-14程度で，次数によらず阻止域の検証に使える
+	 *
+	 *   # 引数
+	 *   vector<double> coef : 係数列(a0, a1, a2[0], a2[1],..., b1, b2[0], b2[1],...)
+	 *   unsigned int nfft : 分割数(2のべき乗かつ次数より大きいこと)
+	 *   #返り値
+	 *   vector<complex<double>> response : 正規化周波数k/nfft (k = 0, 1,..., nfft/2)の
+	 *                                      周波数特性(nfft/2 + 1点)
+	 */
+	vector<complex<double>> dense_freq_res(const vector<double>&, const unsigned int) const;
+
+	/* # フィルタ構造体
+	 *   一様な密グリッド上の周波数特性計算関数(FFT版)
+	 *   係数列を多項式に展開し，0詰めした実数FFTで分子・分母を変換して割る(O(P log P))
+	 *   実測(2^20点)で直接計算より速くなるのは48次前後からで，それ以上でも2割程度しか速くない
+	 *   多項式展開の桁落ちにより，最大振幅に対する誤差が16次で1e-12，32次で1e-8，
+	 *   40次以上で1e-5〜1e-3程度に増える(係数による)
+	 *   阻止域の減衰量の検証には精度が足りないことがあるため，その用途にはdense_freq_resを使うこと
+	 *   引数・返り値はdense_freq_resと同じ
+	 */
+	vector<complex<double>> dense_freq_res_fft(const vector<double>&, const unsigned int) const;
+
+	/* # フィルタ構造体
+	 *   振幅2乗特性計算関数(連続領域版)
+	 *   周波数グリッドの全点の|H|^2を呼び出し側の配列powerに書き込む
+	 */
+	void power_res(const double*, double*) const;
+
+	/* # フィルタ構造体
+	 *   残差とヤコビ行列の計算関数
+	 *   周波数グリッドの全P点(freq_grid().size()点)の複素残差 r = H - D を
+	 *   実数2P次元のベクトルとし，係数列に関する微分を周波数特性と同じ走査で求める
+	 *   各節の対数微分(群遅延と同じ構造)にHを掛けるため，差分近似より速く正確
+	 *   遷移域の所望特性は0として扱う
+	 *
+	 *   # 引数
+	 *   vector<double> coef : 係数列(a0, a1, a2[0], a2[1],..., b1, b2[0], b2[1],...)
+	 *   vector<double>& res : 残差の出力(Re r[0 : P), Im r[0 : P)の2P要素)
+	 *   vector<double>& jac : ヤコビ行列の出力(opt_order() x 2P要素，
+	 *                         jac[k*2P : (k + 1)*2P)がcoef[k]に関する残差の微分)
+	 */
+	void residual_jacobian(const vector<double>&, vector<double>&, vector<double>&) const;
+
+	/* # フィルタ構造体
+	 *   残差とヤコビ行列の計算関数(連続領域版)
+	 *   resに2P要素，jacにopt_order() x 2P要素を書き込む。ヒープ確保は行わない
+	 */
+	void residual_jacobian(const double*, double*, double*) const;
 
 	/* # フィルタ構造体
 	 *   安定性判別関数
@@ -213,11 +660,84 @@ public:
 	 *                         0の場合に安定性を満たす
 	 */
 	double judge_stability(const vector<double>& coef) const
-	{ return this->stability_func(this, coef); }
+	{
+		if (coef.size() != opt_order())
+		{
+			fprintf(stderr,
+				"Error: [%s l.%d]Size of coefficient is illegal.(size : %zu, optimization order : %u)\n",
+				__FILE__, __LINE__, coef.size(), opt_order());
+			exit(EXIT_FAILURE);
+		}
+		return judge_stability(coef.data());
+	}
+
+	/* # フィルタ構造体
+	 *   安定化変数から係数列への写像
+	 *   分母の各節を制約のない実数(安定化変数)q1, q2から極の半径・偏角へ有界に写し，
+	 *   どの安定化変数に対しても安定な係数列を与える
+	 *     2次節 : r = ρ / (1 + e^-q2)，b1 = -2 r cos(q1)，b2 = r^2 (極はr e^(±j q1))
+	 *     1次節 : b1 = ρ tanh(q1)
+	 *   ρは極の半径の上限(1よりわずかに小さい定数)。a0と分子の係数はそのまま写す
+	 *   2次節は複素共役極(実数の重極を含む)のみを表す
+	 *
+	 *   # 引数
+	 *   vector<double> param : 安定化変数(並びは係数列と同じ)
+	 *   #返り値
+	 *   vector<double> coef : 係数列(a0, a1, a2[0], a2[1],..., b1, b2[0], b2[1],...)
+	 */
+	vector<double> stable_to_coef(const vector<double>&) const;
+	void stable_to_coef(const double*, double*) const;
+
+	/* # フィルタ構造体
+	 *   係数列から安定化変数への写像(stable_to_coefの逆写像)
+	 *   安定三角形の外・境界上の節と実数極の組は，表せる近くの節へ射影してから写す
+	 *
+	 *   # 引数
+	 *   vector<double> coef : 係数列(a0, a1, a2[0], a2[1],..., b1, b2[0], b2[1],...)
+	 *   #返り値
+	 *   vector<double> param : 安定化変数
+	 */
+	vector<double> coef_to_stable(const vector<double>&) const;
+	void coef_to_stable(const double*, double*) const;
 
 	double evaluate(const vector<double>&) const;
+	double evaluate_stable(const vector<double>&) const;
+	void evaluate_stable_batch(const double*, const unsigned int, double*) const;
+	void evaluate_stable_batch_parallel(const double*, const unsigned int, double*,
+		ThreadPool& pool = ThreadPool::global()) const;
+	double objective(const double, const double, const double, const double) const;
+
+	/* # フィルタ構造体
+	 *   滑らかな目的関数と勾配の計算関数
+	 *   evaluateの最大値をp = 2^log2p乗平均ノルムで置き換えた
+	 *     F = ||H - D||_p(通過域・阻止域) + riple_weight ||max(|H| - threshold, 0)||_p^2(遷移域)
+	 *         + stability_weight judge_stability
+	 *   と，係数列に関する勾配を周波数グリッドの1回の走査で求める
+	 *   ||u||_p = (Σ u^p / P)^(1/p) はpを大きくすると最大値に近づく
+	 *   誤差は評価方式によらず複素誤差|H - D|とする
+	 *
+	 *   # 引数
+	 *   vector<double> coef : 係数列(a0, a1, a2[0], a2[1],..., b1, b2[0], b2[1],...)
+	 *   unsigned int log2p : ノルムの次数pの2を底とする対数(1以上30以下)
+	 *   vector<double>& grad : 勾配の出力(opt_order()要素)
+	 *   #返り値
+	 *   double value : 目的関数値F
+	 */
+	double smooth_objective(const vector<double>&, const unsigned int, vector<double>&) const;
+	double smooth_objective(const double*, const unsigned int, double*) const;
+	double evaluate_bounded(const vector<double>&, const double) const;
+	double evaluate_bounded(const vector<double>&, const double, EvalOrder&) const;
+	void evaluate_batch(const double*, const unsigned int, double*) const;
+	void evaluate_batch(const vector<double>&, vector<double>&) const;
+	bool use_candidate_lanes() const;
+	void evaluate_batch_parallel(const double*, const unsigned int, double*,
+		ThreadPool& pool = ThreadPool::global()) const;
+	void evaluate_batch_parallel(const vector<double>&, vector<double>&,
+		ThreadPool& pool = ThreadPool::global()) const;
 	vector<double> init_coef(const double, const double, const double) const;
+	vector<double> init_coef(const double, const double, const double, mt19937&) const;
 	vector<double> init_stable_coef(const double, const double) const;
+	vector<double> init_stable_coef(const double, const double, mt19937&) const;
 	
 	void gprint_amp(const vector<double>&, const string&, const double, const double) const;
 	void gprint_mag(const vector<double>&, const string&, const double, const double) const;
@@ -233,6 +753,7 @@ public:
 	static vector<complex<double>> gen_csw(const BandParam&, const unsigned int);
 	static vector<complex<double>> gen_csw2(const BandParam&, const unsigned int);
 	static vector<complex<double>> gen_desire_res(const BandParam&, const unsigned int, const double);
+	static FreqGrid gen_grid(const vector<BandParam>&, const vector<unsigned int>&, const double);
 };
 
 //-------template function---------------------------------------
@@ -0,0 +1,213 @@
+/*
+ * fixed_point_filter.cpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ */
+
+#include "fixed_point_filter.hpp"
+#include "cascade_filter.hpp"
+
+#include <limits>
+
+using namespace std;
+
+template <typename T>
+constexpr unsigned int FixedPointCascadeFilter<T>::npeak;
+template <typename T>
+constexpr int FixedPointCascadeFilter<T>::acc_headroom;
+
+/* # 固定小数点ストリーミングフィルタ
+ *   コンストラクタ
+ *   係数列をCascadeFilterと同じ2次の節に分け，節ごとにスケーリングしてQ形式に量子化する
+ *
+ * # 引数
+ * FilterParam& fparam : 係数列の次数を与えるフィルタパラメータ
+ * vector<double> coef : 係数列(a0, a1, a2[0], a2[1],..., b1, b2[0], b2[1],...)
+ */
+template <typename T>
+FixedPointCascadeFilter<T>::FixedPointCascadeFilter(const FilterParam& fparam, const vector<double>& coef)
+:n_order(fparam.zero_order()), m_order(fparam.pole_order())
+{
+	CascadeFilter cascade(fparam, coef);
+	const unsigned int nsec = cascade.nsection();
+	sections.resize(nsec);
+	state.assign(4*nsec, 0);
+
+	// 先頭から節kまでの縦続の振幅特性の最大値peak[k]
+	vector<double> peak(nsec, 0.0);
+	vector<complex<double>> cumulative(npeak + 1, complex<double>(1.0, 0.0));
+	for (unsigned int k = 0; k < nsec; ++k)
+	{
+		const BiquadSection& sec = cascade.section(k);
+		for (unsigned int i = 0; i <= npeak; ++i)
+		{
+			const complex<double> z1 = polar(1.0, -M_PI*i/npeak);
+			const complex<double> z2 = z1*z1;
+			cumulative[i] *= (sec.b0 + sec.b1*z1 + sec.b2*z2) / (1.0 + sec.a1*z1 + sec.a2*z2);
+			peak[k] = max(peak[k], abs(cumulative[i]));
+		}
+	}
+
+	// 係数の上限はTの範囲と，5項の積和がint64_tに収まる範囲の小さい方
+	// (|係数| <= 2^(63 - acc_headroom - (word_bits - 1))なら，各項は2^(63 - acc_headroom)以下)
+	const int word_bits = 8*sizeof(T);
+	const double coef_limit = min((double)numeric_limits<T>::max(),
+		ldexp(1.0, 63 - acc_headroom - (word_bits - 1)));
+	for (unsigned int k = 0; k < nsec; ++k)
+	{
+		// 途中の節までの振幅特性の最大値を1とし，最後の節で元の利得に戻す
+		const double prev = k == 0 ? 1.0 : peak[k - 1];
+		double scale = 1.0;
+		if (k + 1 < nsec && peak[k] > 0.0)
+		{
+			scale = prev/peak[k];
+		}
+		else if (k + 1 == nsec)
+		{
+			scale = prev;
+		}
+
+		const BiquadSection& sec = cascade.section(k);
+		const double c[] = {scale*sec.b0, scale*sec.b1, scale*sec.b2, sec.a1, sec.a2};
+		double max_coef = 0.0;
+		for (auto v : c)
+		{
+			max_coef = max(max_coef, abs(v));
+		}
+
+		// 最大の係数を丸めてもcoef_limit以下に収まる最大の小数部のビット数
+		int frac = word_bits - 1;
+		while (frac >= 0 && round(ldexp(max_coef, frac)) > coef_limit)
+		{
+			--frac;
+		}
+		if (frac < 0)
+		{
+			fprintf(stderr,
+				"Error: [%s l.%d]Coefficient is too large to quantize.(section : %u, max coefficient : %e)\n",
+				__FILE__, __LINE__, k, max_coef);
+			exit(EXIT_FAILURE);
+		}
+
+		FixedPointSection& q = sections[k];
+		q.frac = frac;
+		q.b0 = (int32_t)round(ldexp(c[0], frac));
+		q.b1 = (int32_t)round(ldexp(c[1], frac));
+		q.b2 = (int32_t)round(ldexp(c[2], frac));
+		q.a1 = (int32_t)round(ldexp(c[3], frac));
+		q.a2 = (int32_t)round(ldexp(c[4], frac));
+	}
+}
+
+/* # 固定小数点ストリーミングフィルタ
+ *   量子化後の係数をFilterParamの係数列の形に戻す
+ *   各節の分子をb0で割ってモニックにし，b0の総乗を利得a0とする
+ *
+ * # 返り値
+ * vector<double> coef : 係数列(a0, a1, a2[0], a2[1],..., b1, b2[0], b2[1],...)
+ */
+template <typename T>
+vector<double> FixedPointCascadeFilter<T>::quantized_coef() const
+{
+	const unsigned int nzero = (n_order + 1)/2;
+	const unsigned int npole = (m_order + 1)/2;
+	vector<double> coef(1 + n_order + m_order);
+
+	double gain = 1.0;
+	unsigned int n = 1;
+	unsigned int m = n_order + 1;
+	for (unsigned int k = 0; k < sections.size(); ++k)
+	{
+		const FixedPointSection& q = sections[k];
+		if (q.b0 == 0)
+		{
+			fprintf(stderr,
+				"Error: [%s l.%d]Quantized gain of section is zero.(section : %u)\n",
+				__FILE__, __LINE__, k);
+			exit(EXIT_FAILURE);
+		}
+		const double b0 = ldexp((double)q.b0, -(int)q.frac);
+		gain *= b0;
+
+		if (k < nzero)
+		{
+			coef[n] = ldexp((double)q.b1, -(int)q.frac) / b0;
+			n += 1;
+			if (!(k == 0 && n_order % 2 == 1))
+			{
+				coef[n] = ldexp((double)q.b2, -(int)q.frac) / b0;
+				n += 1;
+			}
+		}
+		if (k < npole)
+		{
+			coef[m] = ldexp((double)q.a1, -(int)q.frac);
+			m += 1;
+			if (!(k == 0 && m_order % 2 == 1))
+			{
+				coef[m] = ldexp((double)q.a2, -(int)q.frac);
+				m += 1;
+			}
+		}
+	}
+	coef[0] = gain;
+
+	return coef;
+}
+
+/* # 固定小数点ストリーミングフィルタ
+ *   全ての節の状態を0に戻す
+ */
+template <typename T>
+void FixedPointCascadeFilter<T>::reset()
+{
+	fill(state.begin(), state.end(), 0);
+}
+
+/* # 固定小数点ストリーミングフィルタ
+ *   長さlengthの信号dataをその場で処理する
+ *   節ごとに全点を処理して次の節へ進む
+ *     y = sat((b0 x + b1 x[n-1] + b2 x[n-2] - a1 y[n-1] - a2 y[n-2] + 2^(frac-1)) >> frac)
+ */
+template <typename T>
+void FixedPointCascadeFilter<T>::process(T* data, const size_t length)
+{
+	const int64_t lower = numeric_limits<T>::min();
+	const int64_t upper = numeric_limits<T>::max();
+
+	for (unsigned int k = 0; k < sections.size(); ++k)
+	{
+		const FixedPointSection& q = sections[k];
+		const int64_t b0 = q.b0, b1 = q.b1, b2 = q.b2, a1 = q.a1, a2 = q.a2;
+		const unsigned int frac = q.frac;
+		const int64_t half = frac > 0 ? (int64_t)1 << (frac - 1) : 0;
+
+		int64_t x1 = state[4*k], x2 = state[4*k + 1];
+		int64_t y1 = state[4*k + 2], y2 = state[4*k + 3];
+		for (size_t i = 0; i < length; ++i)
+		{
+			const int64_t x = data[i];
+			const int64_t acc = b0*x + b1*x1 + b2*x2 - a1*y1 - a2*y2 + half;
+			const int64_t y = min(upper, max(lower, acc >> frac));
+			x2 = x1;
+			x1 = x;
+			y2 = y1;
+			y1 = y;
+			data[i] = (T)y;
+		}
+		state[4*k] = (T)x1;
+		state[4*k + 1] = (T)x2;
+		state[4*k + 2] = (T)y1;
+		state[4*k + 3] = (T)y2;
+	}
+}
+
+template <typename T>
+void FixedPointCascadeFilter<T>::process(vector<T>& data)
+{
+	process(data.data(), data.size());
+}
+
+template class FixedPointCascadeFilter<int16_t>;
+template class FixedPointCascadeFilter<int32_t>;
@@ -0,0 +1,79 @@
+/*
+ * fixed_point_filter.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ *
+ * This cord is written by UTF-8
+ */
+
+#ifndef FIXED_POINT_FILTER_HPP_
+#define FIXED_POINT_FILTER_HPP_
+
+#include "filter_param.hpp"
+
+/* Q形式に量子化した2次の節
+ *   H(z) = (b0 + b1 z^-1 + b2 z^-2) / (1 + a1 z^-1 + a2 z^-2)
+ *   各係数は整数値を2^fracで割った値を表す(節ごとに小数部のビット数が異なる)
+ */
+struct FixedPointSection
+{
+	int32_t b0, b1, b2;
+	int32_t a1, a2;
+	unsigned int frac;
+
+	FixedPointSection()
+	: b0(0), b1(0), b2(0), a1(0), a2(0), frac(0)
+	{}
+};
+
+/* 設計した縦続型IIRフィルタを整数の信号に適用する固定小数点のストリーミングフィルタ
+ *   T(int16_tまたはint32_t)の信号を，Tと同じビット幅のQ形式の係数で処理する
+ *   節の構成はCascadeFilterと同じで，各節は直接I型で入出力の過去2点を状態に持つ
+ *   積和は64ビットで行い，丸めて右シフトした後にTの範囲に飽和させる
+ *   5項の積和が64ビットを超えないよう，係数は2^(60 - (Tのビット数 - 1))以下に制限する
+ *   (int16_tではTの範囲がそのまま上限となり，int32_tでは2^29が上限となって係数の精度が2ビット下がる)
+ *
+ *   節ごとのスケーリング : 先頭からk番目の節までの縦続の振幅特性の最大値が1になるよう
+ *   各節の分子に倍率を掛け，最後の節で元の利得に戻す
+ *   これは正弦波の定常応答に対するスケーリングで，振幅がフルスケール以内の正弦波入力なら
+ *   途中の節の出力は飽和しない
+ *   任意の入力に対する出力の最大値は縦続のインパルス応答の絶対値和(L1ノルム)で決まり，
+ *   共振の強い節では1を超えるため，過渡応答や広帯域の入力では途中の節が飽和することがある
+ *   (飽和した値はTの最大値・最小値に固定され，折り返しは起きない)
+ *   係数のQ形式は節ごとに，最大の係数が収まる範囲で小数部のビット数を最大にする
+ *
+ *   quantized_coefは量子化後の係数をFilterParamの係数列の形に戻す
+ *   FilterParam::freq_resやevaluateに渡し，量子化による特性の劣化を確認できる
+ */
+template <typename T>
+class FixedPointCascadeFilter
+{
+private:
+	static constexpr unsigned int npeak = 1024;	// スケーリングで振幅特性の最大値を調べる点数
+	static constexpr int acc_headroom = 3;		// 5項の積和がint64_tを超えないよう空けておくビット数
+
+	unsigned int n_order;
+	unsigned int m_order;
+	vector<FixedPointSection> sections;
+	vector<T> state;	// 節kの状態 x[n-1], x[n-2], y[n-1], y[n-2]を state[4k : 4k + 4) に持つ
+
+public:
+	FixedPointCascadeFilter(const FilterParam&, const vector<double>&);
+
+	// get function
+
+	unsigned int nsection() const
+	{ return sections.size(); }
+	const FixedPointSection& section(const unsigned int k) const
+	{ return sections.at(k); }
+	vector<double> quantized_coef() const;
+
+	// normal function
+
+	void reset();
+	void process(T*, const size_t);
+	void process(vector<T>&);
+};
+
+#endif /* FIXED_POINT_FILTER_HPP_ */
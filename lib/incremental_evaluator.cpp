@@ -0,0 +1,362 @@
+/*
+ * incremental_evaluator.cpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ */
+
+#include "incremental_evaluator.hpp"
+#include "cascade_kernel.hpp"
+
+using namespace std;
+
+constexpr unsigned int IncrementalEvaluator::refresh_interval;
+constexpr double IncrementalEvaluator::division_limit;
+
+/* # 差分評価器
+ *   コンストラクタ
+ *
+ * # 引数
+ * FilterParam& fparam : 評価するフィルタパラメータ(評価器より長く存続すること)
+ * vector<double> coef : 初期の係数列(a0, a1, a2[0], a2[1],..., b1, b2[0], b2[1],...)
+ */
+IncrementalEvaluator::IncrementalEvaluator(const FilterParam& fparam, const vector<double>& coef)
+:fparam(fparam), nzero_section(0), nupdate(0)
+{
+	const unsigned int n_order = fparam.zero_order();
+	const unsigned int m_order = fparam.pole_order();
+
+	unsigned int n = 1;
+	if (n_order % 2 == 1)
+	{
+		section_index.push_back(n);
+		section_width.push_back(1);
+		n = 2;
+	}
+	for (; n < n_order; n += 2)
+	{
+		section_index.push_back(n);
+		section_width.push_back(2);
+	}
+	nzero_section = section_index.size();
+
+	unsigned int m = n_order + 1;
+	if (m_order % 2 == 1)
+	{
+		section_index.push_back(m);
+		section_width.push_back(1);
+		m = n_order + 2;
+	}
+	for (; m < fparam.opt_order(); m += 2)
+	{
+		section_index.push_back(m);
+		section_width.push_back(2);
+	}
+
+	reset(coef);
+}
+
+/* # 差分評価器
+ *   係数列のindex番目の係数を含む節の番号を返す
+ *   index = 0(a0)の場合はnsection()を返す
+ */
+unsigned int IncrementalEvaluator::section_of(const unsigned int index) const
+{
+	if (index == 0)
+	{
+		return nsection();
+	}
+	for (unsigned int k = 0; k < nsection(); ++k)
+	{
+		if (index < section_index[k] + section_width[k])
+		{
+			return k;
+		}
+	}
+
+	fprintf(stderr,
+		"Error: [%s l.%d]Coefficient index is out of range.(index : %u, optimization order : %u)\n",
+		__FILE__, __LINE__, index, fparam.opt_order());
+	exit(EXIT_FAILURE);
+}
+
+/* # 差分評価器
+ *   係数列を置き換え，節の総乗を計算し直す
+ */
+void IncrementalEvaluator::reset(const vector<double>& input)
+{
+	if (input.size() != fparam.opt_order())
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, input.size(), fparam.opt_order());
+		exit(EXIT_FAILURE);
+	}
+
+	coef = input;
+	recompute();
+}
+
+/* # 差分評価器
+ *   全ての節の総乗を係数列から計算する(O(グリッド点数 x 節数))
+ */
+void IncrementalEvaluator::recompute()
+{
+	const FreqGrid& grid = fparam.freq_grid();
+	n_re.assign(grid.size(), 1.0);
+	n_im.assign(grid.size(), 0.0);
+	d_re.assign(grid.size(), 1.0);
+	d_im.assign(grid.size(), 0.0);
+
+	for (unsigned int k = 0; k < nsection(); ++k)
+	{
+		double* pr = is_pole_section(k) ? d_re.data() : n_re.data();
+		double* pi = is_pole_section(k) ? d_im.data() : n_im.data();
+		const double c1 = coef[section_index[k]];
+		const double c2 = section_width[k] == 2 ? coef[section_index[k] + 1] : 0.0;
+
+		for (unsigned int j = 0; j < grid.size(); ++j)
+		{
+			const double sr = 1.0 + c1*grid.csw_re[j] + c2*grid.csw2_re[j];
+			const double si = c1*grid.csw_im[j] + c2*grid.csw2_im[j];
+			const double tr = pr[j]*sr - pi[j]*si;
+			pi[j] = pr[j]*si + pi[j]*sr;
+			pr[j] = tr;
+		}
+	}
+	nupdate = 0;
+}
+
+/* # 差分評価器
+ *   利得a0を変更する(O(1))
+ */
+void IncrementalEvaluator::update_gain(const double a0)
+{
+	coef[0] = a0;
+}
+
+/* # 差分評価器
+ *   節kの係数をcで置き換え，総乗を古い節で割って新しい節を掛けることで更新する
+ *   割り算が不安定な場合と差分更新が続いた場合は総乗を計算し直す
+ *
+ * # 引数
+ * unsigned int k : 節の番号
+ * double* c : 新しい係数(section_size(k)個)
+ */
+void IncrementalEvaluator::update_section(const unsigned int k, const double* c)
+{
+	const unsigned int begin = section_index.at(k);
+	const double o1 = coef[begin];
+	const double o2 = section_width[k] == 2 ? coef[begin + 1] : 0.0;
+	const double c1 = c[0];
+	const double c2 = section_width[k] == 2 ? c[1] : 0.0;
+
+	coef[begin] = c1;
+	if (section_width[k] == 2)
+	{
+		coef[begin + 1] = c2;
+	}
+
+	if (++nupdate >= refresh_interval)
+	{
+		recompute();
+		return;
+	}
+
+	const FreqGrid& grid = fparam.freq_grid();
+	double* pr = is_pole_section(k) ? d_re.data() : n_re.data();
+	double* pi = is_pole_section(k) ? d_im.data() : n_im.data();
+	for (unsigned int j = 0; j < grid.size(); ++j)
+	{
+		const double or_ = 1.0 + o1*grid.csw_re[j] + o2*grid.csw2_re[j];
+		const double oi = o1*grid.csw_im[j] + o2*grid.csw2_im[j];
+		const double onorm = or_*or_ + oi*oi;
+		if (onorm < division_limit)
+		{
+			recompute();
+			return;
+		}
+
+		// 比 S_new / S_old を掛ける
+		const double sr = 1.0 + c1*grid.csw_re[j] + c2*grid.csw2_re[j];
+		const double si = c1*grid.csw_im[j] + c2*grid.csw2_im[j];
+		const double rr = (sr*or_ + si*oi) / onorm;
+		const double ri = (si*or_ - sr*oi) / onorm;
+		const double tr = pr[j]*rr - pi[j]*ri;
+		pi[j] = pr[j]*ri + pi[j]*rr;
+		pr[j] = tr;
+	}
+}
+
+/* # 差分評価器
+ *   保持中の総乗に節の比を掛けた周波数特性を計算する
+ *     H = a0 * (N * (1 + a1 e^-jω + a2 e^-j2ω)) / (D * (1 + b1 e^-jω + b2 e^-j2ω))
+ *   分子側の節を変える場合は(a1, a2)を新しい節，(b1, b2)を古い節とし，
+ *   分母側の節を変える場合はその逆とする。古い節で割る操作は分母へ掛ける操作になるため，
+ *   点ごとの除算は|D|^2の1回で済む
+ *   onormには古い節(o1, o2)の絶対値の2乗を返す
+ */
+template <typename V>
+static SIMD_INLINE void replaced_res
+(const FreqGrid& grid, const unsigned int j,
+	const double* nre, const double* nim, const double* dre, const double* dim,
+	const double a0, const double a1, const double a2, const double b1, const double b2,
+	const double o1, const double o2,
+	typename V::reg& hr, typename V::reg& hi, typename V::reg& onorm)
+{
+	typedef typename V::reg reg;
+
+	const reg z1r = V::load(grid.csw_re.data() + j);
+	const reg z1i = V::load(grid.csw_im.data() + j);
+	const reg z2r = V::load(grid.csw2_re.data() + j);
+	const reg z2i = V::load(grid.csw2_im.data() + j);
+
+	reg nr = V::load(nre + j);
+	reg ni = V::load(nim + j);
+	reg dr = V::load(dre + j);
+	reg di = V::load(dim + j);
+	mul_section<V>(a1, a2, z1r, z1i, z2r, z2i, nr, ni);
+	mul_section<V>(b1, b2, z1r, z1i, z2r, z2i, dr, di);
+
+	const reg v1 = V::set1(o1);
+	const reg v2 = V::set1(o2);
+	const reg sr = V::fmadd(v2, z2r, V::fmadd(v1, z1r, V::set1(1.0)));
+	const reg si = V::fmadd(v2, z2i, V::mul(v1, z1i));
+	onorm = V::fmadd(sr, sr, V::mul(si, si));
+
+	divide_res<V>(a0, nr, ni, dr, di, hr, hi);
+}
+
+/* # 差分評価器
+ *   節kをcに置き換えた場合の最大誤差・最大振幅隆起を保持中の総乗から求める
+ *   k = nsection()の場合は置き換えを行わない
+ *   古い節の値が0に近い点があればfalseを返す
+ */
+bool IncrementalEvaluator::sweep
+(const unsigned int k, const double* c, double& max_error, double& max_riple) const
+{
+	typedef SimdNative V;
+	const FreqGrid& grid = fparam.freq_grid();
+	const double threshold = fparam.riple_threshold();
+
+	// 置き換えない場合は両側とも1を掛ける
+	double o1 = 0.0, o2 = 0.0, c1 = 0.0, c2 = 0.0;
+	if (k < nsection())
+	{
+		o1 = coef[section_index[k]];
+		o2 = section_width[k] == 2 ? coef[section_index[k] + 1] : 0.0;
+		c1 = c[0];
+		c2 = section_width[k] == 2 ? c[1] : 0.0;
+	}
+	const bool pole = k < nsection() && is_pole_section(k);
+	const double a1 = pole ? o1 : c1;
+	const double a2 = pole ? o2 : c2;
+	const double b1 = pole ? c1 : o1;
+	const double b2 = pole ? c2 : o2;
+	const double a0 = coef[0];
+
+	const V::reg vthreshold = V::set1(threshold);
+	V::reg vmax_error = V::zero();
+	V::reg vmax_riple = V::zero();
+	V::reg vmin_norm = V::set1(-1.0e300);	// 古い節の絶対値の2乗の最小値(符号反転して最大値で保持)
+	double min_norm = 1.0e300;
+	max_error = 0.0;
+	max_riple = 0.0;
+
+	for (unsigned int i = 0; i < grid.nband(); ++i)    // 周波数帯域のループ
+	{
+		if (grid.band_size(i) == 0)
+		{
+			continue;
+		}
+		const unsigned int end = grid.band_end(i);
+		const bool transition = grid.band_type[grid.band_begin(i)] == BandType::Transition;
+
+		unsigned int j = grid.band_begin(i);
+		for (; j + V::width <= end; j += V::width)
+		{
+			V::reg hr, hi, onorm;
+			replaced_res<V>(grid, j, n_re.data(), n_im.data(), d_re.data(), d_im.data(),
+				a0, a1, a2, b1, b2, o1, o2, hr, hi, onorm);
+			vmin_norm = V::max(vmin_norm, V::sub(V::zero(), onorm));
+			if (transition)
+			{
+				const V::reg amp = V::sqrt(V::fmadd(hr, hr, V::mul(hi, hi)));
+				vmax_riple = V::max(vmax_riple, V::keep_gt(amp, vthreshold));
+			}
+			else
+			{
+				const V::reg er = V::sub(V::load(grid.desire_re.data() + j), hr);
+				const V::reg ei = V::sub(V::load(grid.desire_im.data() + j), hi);
+				vmax_error = V::max(vmax_error, V::sqrt(V::fmadd(er, er, V::mul(ei, ei))));
+			}
+		}
+		for (; j < end; ++j)
+		{
+			double hr, hi, onorm;
+			replaced_res<SimdScalar>(grid, j, n_re.data(), n_im.data(), d_re.data(), d_im.data(),
+				a0, a1, a2, b1, b2, o1, o2, hr, hi, onorm);
+			min_norm = min(min_norm, onorm);
+			if (transition)
+			{
+				const double amp = sqrt(hr*hr + hi*hi);
+				if (amp > threshold && amp > max_riple)
+				{
+					max_riple = amp;
+				}
+			}
+			else
+			{
+				const double er = grid.desire_re[j] - hr;
+				const double ei = grid.desire_im[j] - hi;
+				max_error = max(max_error, sqrt(er*er + ei*ei));
+			}
+		}
+	}
+
+	max_error = max(max_error, V::hmax(vmax_error));
+	max_riple = max(max_riple, V::hmax(vmax_riple));
+	min_norm = min(min_norm, -V::hmax(vmin_norm));
+	return min_norm >= division_limit;
+}
+
+/* # 差分評価器
+ *   現在の係数列の目的関数値(FilterParam::evaluateと同じ値)を計算する(O(グリッド点数))
+ */
+double IncrementalEvaluator::evaluate() const
+{
+	if (fparam.evaluation_mode() != EvalMode::Complex)
+	{
+		return fparam.evaluate(coef);
+	}
+
+	double max_error, max_riple;
+	sweep(nsection(), nullptr, max_error, max_riple);
+	return fparam.objective(max_error, max_riple, 0.0, fparam.judge_stability(coef));
+}
+
+/* # 差分評価器
+ *   節kの係数をcに置き換えた場合の目的関数値を，状態を変更せずに計算する(O(グリッド点数))
+ *   候補を採用する場合はupdate_sectionを呼ぶ
+ *
+ * # 引数
+ * unsigned int k : 節の番号
+ * double* c : 試す係数(section_size(k)個)
+ */
+double IncrementalEvaluator::evaluate_section(const unsigned int k, const double* c) const
+{
+	// 置き換え後の係数列(安定性の判定と全体計算への切り替えに使う)
+	thread_local vector<double> trial;
+	trial.assign(coef.begin(), coef.end());
+	for (unsigned int i = 0; i < section_width.at(k); ++i)
+	{
+		trial[section_index[k] + i] = c[i];
+	}
+
+	double max_error, max_riple;
+	if (fparam.evaluation_mode() != EvalMode::Complex || !sweep(k, c, max_error, max_riple))
+	{
+		return fparam.evaluate(trial);
+	}
+	return fparam.objective(max_error, max_riple, 0.0, fparam.judge_stability(trial));
+}
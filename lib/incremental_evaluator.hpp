@@ -0,0 +1,72 @@
+/*
+ * incremental_evaluator.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ *
+ * This cord is written by UTF-8
+ */
+
+#ifndef INCREMENTAL_EVALUATOR_HPP_
+#define INCREMENTAL_EVALUATOR_HPP_
+
+#include "filter_param.hpp"
+
+/* 1つの節だけを変更する局所探索・突然変異のための差分評価器
+ *   周波数グリッドの全点について分子・分母の節の総乗N, Dを保持し，
+ *   節を変更したときは古い節で割り，新しい節を掛けてO(グリッド点数)で更新する
+ *
+ *   節の番号は分子の節(奇数次なら先頭が1次の節)，分母の節の順に振る
+ *     例) 分子5次・分母4次 : 0 : a1, 1 : (a2[0], a2[1]), 2 : (a2[2], a2[3]),
+ *                            3 : (b2[0], b2[1]), 4 : (b2[2], b2[3])
+ *
+ *   古い節の値が0に近い点があり割り算が不安定な場合と，
+ *   差分更新がrefresh_interval回続いた場合は総乗を係数から計算し直す
+ *   EvalMode::Complex以外の評価方式ではFilterParam::evaluateで全体を計算する
+ */
+struct IncrementalEvaluator
+{
+protected:
+	static constexpr unsigned int refresh_interval = 64;	// 差分更新の回数の上限
+	static constexpr double division_limit = 1.0e-8;		// 割り算を許す節の絶対値の2乗の下限
+
+	const FilterParam& fparam;
+	vector<double> coef;
+	vector<unsigned int> section_index;	// 節kの係数の先頭位置
+	vector<unsigned int> section_width;	// 節kの係数の数(1または2)
+	unsigned int nzero_section;			// 分子の節の数
+
+	aligned_vector<double> n_re, n_im;	// 分子の節の総乗
+	aligned_vector<double> d_re, d_im;	// 分母の節の総乗
+	unsigned int nupdate;
+
+	void recompute();
+	bool sweep(const unsigned int, const double*, double&, double&) const;
+
+public:
+	IncrementalEvaluator(const FilterParam&, const vector<double>&);
+
+	// get function
+
+	const vector<double>& coefficient() const
+	{ return coef; }
+	unsigned int nsection() const
+	{ return section_index.size(); }
+	unsigned int section_begin(const unsigned int k) const
+	{ return section_index.at(k); }
+	unsigned int section_size(const unsigned int k) const
+	{ return section_width.at(k); }
+	bool is_pole_section(const unsigned int k) const
+	{ return k >= nzero_section; }
+	unsigned int section_of(const unsigned int) const;
+
+	// normal function
+
+	void reset(const vector<double>&);
+	void update_gain(const double);
+	void update_section(const unsigned int, const double*);
+	double evaluate() const;
+	double evaluate_section(const unsigned int, const double*) const;
+};
+
+#endif /* INCREMENTAL_EVALUATOR_HPP_ */
@@ -0,0 +1,221 @@
+/*
+ * lbfgs.cpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ */
+
+#include "lbfgs.hpp"
+
+using namespace std;
+
+namespace
+{
+	double dot(const vector<double>& a, const vector<double>& b)
+	{
+		double sum = 0.0;
+		for (unsigned int i = 0; i < a.size(); ++i)
+		{
+			sum += a[i]*b[i];
+		}
+		return sum;
+	}
+}
+
+/* # L-BFGS法
+ *   コンストラクタ
+ *
+ * # 引数
+ * FilterParam& fparam : 最適化するフィルタのパラメータ
+ * LBFGSParam param : L-BFGS法のパラメータ
+ */
+LBFGS::LBFGS(const FilterParam& fparam, const LBFGSParam& param)
+:fparam(fparam), param(param)
+{}
+
+/* # L-BFGS法
+ *   係数列startから局所最適化を行う
+ *   焼きなましの全段の終了，または目標値への到達で終了する
+ *   評価回数nevaluationはsmooth_objectiveとevaluateの呼び出し回数の合計
+ *
+ * # 引数
+ * vector<double> start : 初期の係数列
+ * # 返り値
+ * OptimizeResult result : evaluateで最良の係数列・目的関数値と反復ごとの最良値
+ *                         (stopは最後の段が反復回数の上限で終わればGeneration，
+ *                          それ以外はStagnation)
+ */
+OptimizeResult LBFGS::run(const vector<double>& start)
+{
+	const unsigned int n = fparam.opt_order();
+	if (start.size() != n)
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, start.size(), n);
+		exit(EXIT_FAILURE);
+	}
+
+	const unsigned int memory = max(1u, param.memory);
+	vector<vector<double>> s_hist(memory, vector<double>(n)), y_hist(memory, vector<double>(n));
+	vector<double> rho(memory), alpha(memory);
+	vector<double> x = start, g(n), d(n), x_new(n), g_new(n), s(n), y(n);
+
+	// 初期の逆ヘッセ行列の対角の重み
+	// 利得a0は他の係数より桁違いに小さくなりうるため，初期値の大きさの2乗で縮める
+	vector<double> scale(n, 1.0);
+	if (start[0] != 0.0)
+	{
+		scale[0] = min(1.0, start[0]*start[0]);
+	}
+
+	OptimizeResult result;
+	result.coef = start;
+	result.value = fparam.evaluate(start);
+	result.nevaluation = 1;
+	result.history.push_back(result.value);
+	result.stop = StopReason::Stagnation;
+
+	for (unsigned int log2p = param.log2p_begin; log2p <= param.log2p_end; ++log2p)
+	{
+		// 目的関数が変わるため，段ごとに修正対を捨てる
+		unsigned int count = 0, head = 0;
+		double f = fparam.smooth_objective(x.data(), log2p, g.data());
+		++result.nevaluation;
+
+		unsigned int iteration = 0;
+		for (; iteration < param.max_iteration; ++iteration)
+		{
+			// 2ループ再帰で d = -H g
+			for (unsigned int i = 0; i < n; ++i)
+			{
+				d[i] = -g[i];
+			}
+			for (unsigned int c = 0; c < count; ++c)
+			{
+				const unsigned int k = (head + memory - 1 - c) % memory;
+				alpha[k] = rho[k]*dot(s_hist[k], d);
+				for (unsigned int i = 0; i < n; ++i)
+				{
+					d[i] -= alpha[k]*y_hist[k][i];
+				}
+			}
+			// H0 = γ diag(scale)
+			double gamma = 1.0;
+			if (count > 0)
+			{
+				const unsigned int k = (head + memory - 1) % memory;
+				double yhy = 0.0;
+				for (unsigned int i = 0; i < n; ++i)
+				{
+					yhy += scale[i]*y_hist[k][i]*y_hist[k][i];
+				}
+				gamma = dot(s_hist[k], y_hist[k])/yhy;
+			}
+			else
+			{
+				double gmax = 0.0;
+				for (unsigned int i = 0; i < n; ++i)
+				{
+					gmax = max(gmax, sqrt(scale[i])*abs(g[i]));
+				}
+				gamma = gmax > 0.0 ? min(1.0, 1.0/gmax) : 1.0;
+			}
+			for (unsigned int i = 0; i < n; ++i)
+			{
+				d[i] *= gamma*scale[i];
+			}
+			for (unsigned int c = count; c-- > 0; )
+			{
+				const unsigned int k = (head + memory - 1 - c) % memory;
+				const double beta = rho[k]*dot(y_hist[k], d);
+				for (unsigned int i = 0; i < n; ++i)
+				{
+					d[i] += (alpha[k] - beta)*s_hist[k][i];
+				}
+			}
+			double slope = dot(g, d);
+			if (!(slope < 0.0))
+			{
+				// 降下方向でなければ最急降下方向からやり直す
+				count = 0;
+				for (unsigned int i = 0; i < n; ++i)
+				{
+					d[i] = -gamma*scale[i]*g[i];
+				}
+				slope = dot(g, d);
+				if (!(slope < 0.0))
+				{
+					break;
+				}
+			}
+
+			// Armijo条件の直線探索(安定な点からは不安定な点へ進まない)
+			const bool keep_stable = fparam.judge_stability(x) == 0.0;
+			double step = 1.0, f_new = f;
+			bool accepted = false;
+			for (unsigned int t = 0; t < param.max_line_search && !accepted; ++t, step *= 0.5)
+			{
+				for (unsigned int i = 0; i < n; ++i)
+				{
+					x_new[i] = x[i] + step*d[i];
+				}
+				if (keep_stable && fparam.judge_stability(x_new) > 0.0)
+				{
+					continue;
+				}
+				f_new = fparam.smooth_objective(x_new.data(), log2p, g_new.data());
+				++result.nevaluation;
+				accepted = f_new <= f + 1.0e-4*step*slope;
+			}
+			if (!accepted)
+			{
+				break;
+			}
+
+			// 修正対の更新(曲率条件を満たすときのみ)
+			// 満たさない対で履歴を上書きしないよう，作業領域で作ってから移す
+			for (unsigned int i = 0; i < n; ++i)
+			{
+				s[i] = x_new[i] - x[i];
+				y[i] = g_new[i] - g[i];
+			}
+			const double sy = dot(s, y);
+			if (sy > 1.0e-12*sqrt(dot(s, s)*dot(y, y)))
+			{
+				s_hist[head].swap(s);
+				y_hist[head].swap(y);
+				rho[head] = 1.0/sy;
+				head = (head + 1) % memory;
+				count = min(count + 1, memory);
+			}
+
+			const double decrease = f - f_new;
+			x.swap(x_new);
+			g.swap(g_new);
+			f = f_new;
+
+			const double value = fparam.evaluate(x);
+			++result.nevaluation;
+			++result.generation;
+			if (value < result.value)
+			{
+				result.value = value;
+				result.coef = x;
+			}
+			result.history.push_back(result.value);
+			if (result.value <= param.target)
+			{
+				result.stop = StopReason::Target;
+				return result;
+			}
+			if (decrease < param.tol*abs(f))
+			{
+				break;
+			}
+		}
+		result.stop = iteration >= param.max_iteration ? StopReason::Generation : StopReason::Stagnation;
+	}
+
+	return result;
+}
@@ -0,0 +1,69 @@
+/*
+ * lbfgs.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ *
+ * This cord is written by UTF-8
+ */
+
+#ifndef LBFGS_HPP_
+#define LBFGS_HPP_
+
+#include "filter_param.hpp"
+#include "optimizer.hpp"
+
+/* L-BFGS法のパラメータ
+ *   memory : 保持する修正対(s, y)の数
+ *   log2p_begin, log2p_end : ノルムの次数p = 2^log2pの焼きなまし範囲
+ *                            段ごとにlog2pを1ずつ増やし(pを2倍にし)，前の段の解から再開する
+ *   max_iteration : 1段あたりの反復回数の上限
+ *   max_line_search : 直線探索でステップ幅を半分にする回数の上限
+ *   tol : 滑らかな目的関数の相対減少量がこれ未満になったら次の段へ進む
+ *   target : evaluateの目標値(これ以下で終了)
+ */
+struct LBFGSParam
+{
+	unsigned int memory;
+	unsigned int log2p_begin;
+	unsigned int log2p_end;
+	unsigned int max_iteration;
+	unsigned int max_line_search;
+	double tol;
+	double target;
+
+	LBFGSParam()
+	: memory(8), log2p_begin(3), log2p_end(8), max_iteration(100), max_line_search(40),
+	  tol(1.0e-9), target(0.0)
+	{}
+};
+
+/* フィルタ係数のL-BFGS法による局所最適化器
+ *   FilterParam::smooth_objectiveの値と勾配で準ニュートン法を行い，
+ *   pを段ごとに大きくして最大誤差(evaluate)の最小化に近づける
+ *   初期の逆ヘッセ行列は対角で，利得a0の成分だけ初期値の大きさの2乗に縮める
+ *   安定な点から始めた場合，judge_stabilityが正になる点は直線探索で棄却し，
+ *   反復の間ずっと安定性を保つ(不安定な点からはペナルティの勾配で安定域へ戻す)
+ *   結果は反復ごとにevaluateで比べた最良の係数列で，初期値より悪くならない
+ *   パイプラインの最終段の局所最適化を想定する
+ */
+class LBFGS
+{
+private:
+	const FilterParam& fparam;
+	LBFGSParam param;
+
+public:
+	LBFGS(const FilterParam&, const LBFGSParam& param = LBFGSParam());
+
+	// get function
+
+	const LBFGSParam& parameter() const
+	{ return param; }
+
+	// normal function
+
+	OptimizeResult run(const vector<double>&);
+};
+
+#endif /* LBFGS_HPP_ */
@@ -0,0 +1,252 @@
+/*
+ * levenberg_marquardt.cpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ */
+
+#include "levenberg_marquardt.hpp"
+
+#include <limits>
+
+using namespace std;
+
+namespace
+{
+	/* # 連立1次方程式の求解(Cholesky分解)
+	 *   対称正定値行列A(n x n)について A x = b を解き，bをxで置き換える
+	 *   Aの下三角は分解後の行列で置き換わる。正定値でなければfalseを返す
+	 */
+	bool solve_cholesky(double* A, double* b, const unsigned int n)
+	{
+		for (unsigned int j = 0; j < n; ++j)
+		{
+			double d = A[(size_t)j*n + j];
+			for (unsigned int k = 0; k < j; ++k)
+			{
+				d -= A[(size_t)j*n + k]*A[(size_t)j*n + k];
+			}
+			if (!(d > 0.0))
+			{
+				return false;
+			}
+			d = sqrt(d);
+			A[(size_t)j*n + j] = d;
+			for (unsigned int i = j + 1; i < n; ++i)
+			{
+				double s = A[(size_t)i*n + j];
+				for (unsigned int k = 0; k < j; ++k)
+				{
+					s -= A[(size_t)i*n + k]*A[(size_t)j*n + k];
+				}
+				A[(size_t)i*n + j] = s/d;
+			}
+		}
+
+		for (unsigned int i = 0; i < n; ++i)
+		{
+			for (unsigned int k = 0; k < i; ++k)
+			{
+				b[i] -= A[(size_t)i*n + k]*b[k];
+			}
+			b[i] /= A[(size_t)i*n + i];
+		}
+		for (unsigned int i = n; i-- > 0; )
+		{
+			for (unsigned int k = i + 1; k < n; ++k)
+			{
+				b[i] -= A[(size_t)k*n + i]*b[k];
+			}
+			b[i] /= A[(size_t)i*n + i];
+		}
+		return true;
+	}
+}
+
+/* # Levenberg-Marquardt法
+ *   コンストラクタ
+ *
+ * # 引数
+ * FilterParam& fparam : 改良するフィルタのパラメータ
+ * LMParam param : Levenberg-Marquardt法のパラメータ
+ */
+LevenbergMarquardt::LevenbergMarquardt(const FilterParam& fparam, const LMParam& param)
+:fparam(fparam), param(param)
+{}
+
+/* # Levenberg-Marquardt法
+ *   係数列startから局所改良を行う
+ *   目標値への到達，反復回数の上限，μの上限(改善できない)のいずれかで終了する
+ *   Lawson法の重みでμが上限を超えた場合は，一様な重みに戻して1度だけ続ける
+ *   評価回数nevaluationはevaluateとresidual_jacobianの呼び出し回数の合計
+ *
+ * # 引数
+ * vector<double> start : 初期の係数列(差分進化・CMA-ES等の結果)
+ * # 返り値
+ * OptimizeResult result : 最良の係数列・目的関数値と反復ごとの最良値
+ */
+OptimizeResult LevenbergMarquardt::run(const vector<double>& start)
+{
+	const unsigned int n = fparam.opt_order();
+	if (start.size() != n)
+	{
+		fprintf(stderr,
+			"Error: [%s l.%d]Size of coefficient is illegal.(size : %zu, optimization order : %u)\n",
+			__FILE__, __LINE__, start.size(), n);
+		exit(EXIT_FAILURE);
+	}
+
+	const FreqGrid& grid = fparam.freq_grid();
+	const unsigned int npoint = grid.size();
+	const size_t stride = 2*(size_t)npoint;
+
+	vector<double> res(stride), jac(n*stride), wrow(stride);
+	vector<double> normal((size_t)n*n), system((size_t)n*n), grad(n), step(n), trial(n);
+
+	// 点ごとの重み(通過域・阻止域で一様，遷移域は0)
+	vector<double> weight(npoint);
+	double wsum = 0.0;
+	for (unsigned int j = 0; j < npoint; ++j)
+	{
+		weight[j] = grid.band_type[j] == BandType::Transition ? 0.0 : 1.0;
+		wsum += weight[j];
+	}
+	for (auto& w : weight)
+	{
+		w /= wsum;
+	}
+	const double wsum_uniform = wsum;
+
+	OptimizeResult result;
+	result.coef = start;
+	result.value = fparam.evaluate(start);
+	result.nevaluation = 1;
+	result.history.push_back(result.value);
+
+	double mu = param.damping;
+	bool update = true;		// 係数が変わり，正規方程式を作り直す
+	bool first = true;
+	bool lawson = param.lawson;
+	while (true)
+	{
+		if (result.value <= param.target)
+		{
+			result.stop = StopReason::Target;
+			break;
+		}
+		if (result.generation >= param.max_iteration)
+		{
+			result.stop = StopReason::Generation;
+			break;
+		}
+		if (mu > param.max_damping)
+		{
+			if (!lawson)
+			{
+				result.stop = StopReason::Stagnation;
+				break;
+			}
+			// Lawson法の重みで改善できなくなったら，一様な重みに戻して続ける
+			lawson = false;
+			for (unsigned int j = 0; j < npoint; ++j)
+			{
+				weight[j] = grid.band_type[j] == BandType::Transition ? 0.0 : 1.0/wsum_uniform;
+			}
+			mu = param.damping;
+			update = true;
+		}
+
+		if (update)
+		{
+			fparam.residual_jacobian(result.coef.data(), res.data(), jac.data());
+			++result.nevaluation;
+
+			// Lawson法の重みの更新 w <- (1 - mix) w |r| / Σ w |r| + mix / N
+			if (lawson && !first)
+			{
+				wsum = 0.0;
+				for (unsigned int j = 0; j < npoint; ++j)
+				{
+					weight[j] *= sqrt(res[j]*res[j] + res[npoint + j]*res[npoint + j]);
+					wsum += weight[j];
+				}
+				if (wsum > 0.0)
+				{
+					// 一様な重みを混ぜ，重みが少数の点に集中して停滞するのを防ぐ
+					const double mix = param.lawson_mix;
+					for (unsigned int j = 0; j < npoint; ++j)
+					{
+						weight[j] = (1.0 - mix)*weight[j]/wsum
+							+ (grid.band_type[j] == BandType::Transition ? 0.0 : mix/wsum_uniform);
+					}
+				}
+			}
+			first = false;
+
+			// 正規方程式 J^T W J，J^T W r(ヤコビ行列は係数ごとの行が連続)
+			for (unsigned int a = 0; a < n; ++a)
+			{
+				const double* ja = &jac[a*stride];
+				for (unsigned int j = 0; j < npoint; ++j)
+				{
+					wrow[j] = weight[j]*ja[j];
+					wrow[npoint + j] = weight[j]*ja[npoint + j];
+				}
+				double g = 0.0;
+				for (size_t j = 0; j < stride; ++j)
+				{
+					g += wrow[j]*res[j];
+				}
+				grad[a] = g;
+				for (unsigned int b = 0; b <= a; ++b)
+				{
+					const double* jb = &jac[b*stride];
+					double s = 0.0;
+					for (size_t j = 0; j < stride; ++j)
+					{
+						s += wrow[j]*jb[j];
+					}
+					normal[(size_t)a*n + b] = normal[(size_t)b*n + a] = s;
+				}
+			}
+			update = false;
+		}
+
+		// (J^T W J + μ diag(J^T W J)) δ = -J^T W r
+		system = normal;
+		for (unsigned int i = 0; i < n; ++i)
+		{
+			system[(size_t)i*n + i] += mu*normal[(size_t)i*n + i] + numeric_limits<double>::min();
+			step[i] = -grad[i];
+		}
+
+		++result.generation;
+		if (solve_cholesky(system.data(), step.data(), n))
+		{
+			for (unsigned int i = 0; i < n; ++i)
+			{
+				trial[i] = result.coef[i] + step[i];
+			}
+			const double value = fparam.evaluate(trial);
+			++result.nevaluation;
+			if (value < result.value)
+			{
+				result.coef = trial;
+				result.value = value;
+				mu *= param.damping_down;
+				update = true;
+			}
+			else
+			{
+				mu *= param.damping_up;
+			}
+		}
+		else
+		{
+			mu *= param.damping_up;
+		}
+		result.history.push_back(result.value);
+	}
+
+	return result;
+}
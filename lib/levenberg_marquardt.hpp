@@ -0,0 +1,72 @@
+/*
+ * levenberg_marquardt.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ *
+ * This cord is written by UTF-8
+ */
+
+#ifndef LEVENBERG_MARQUARDT_HPP_
+#define LEVENBERG_MARQUARDT_HPP_
+
+#include "filter_param.hpp"
+#include "optimizer.hpp"
+
+/* Levenberg-Marquardt法のパラメータ
+ *   max_iteration : 反復回数の上限
+ *   damping : 減衰係数μの初期値
+ *   damping_up, damping_down : ステップを棄却・採択したときにμに掛ける倍率
+ *   max_damping : μがこれを超えたら改善できないとみなして終了
+ *   lawson : trueなら採択のたびに点ごとの重みを誤差に比例して更新する(Lawson法)
+ *            重み付き2乗誤差の最小化を最大誤差の最小化に近づける
+ *            重みで改善できなくなったら一様な重みに戻して続ける
+ *   lawson_mix : Lawson法の重みの更新で混ぜる一様な重みの割合[0 : 1]
+ *                0では重みが少数の点に集中し，早く停滞することがある
+ *   target : 目的関数値の目標値(これ以下で終了)
+ */
+struct LMParam
+{
+	unsigned int max_iteration;
+	double damping;
+	double damping_up;
+	double damping_down;
+	double max_damping;
+	bool lawson;
+	double lawson_mix;
+	double target;
+
+	LMParam()
+	: max_iteration(50), damping(1.0e-3), damping_up(10.0), damping_down(0.3),
+	  max_damping(1.0e10), lawson(true), lawson_mix(0.2), target(0.0)
+	{}
+};
+
+/* フィルタ係数のLevenberg-Marquardt法による局所改良器
+ *   FilterParam::residual_jacobianの残差とヤコビ行列から
+ *   (J^T W J + μ diag(J^T W J)) δ = -J^T W r を解いてステップδを求める
+ *   重みWは通過域・阻止域の点に置き，遷移域は0とする
+ *   ステップの採否はevaluate(振幅隆起・安定性のペナルティを含む)で決めるため，
+ *   結果の目的関数値は初期値より悪くならない
+ *   メタヒューリスティクスの結果を数十回の評価で仕上げる用途を想定する
+ */
+class LevenbergMarquardt
+{
+private:
+	const FilterParam& fparam;
+	LMParam param;
+
+public:
+	LevenbergMarquardt(const FilterParam&, const LMParam& param = LMParam());
+
+	// get function
+
+	const LMParam& parameter() const
+	{ return param; }
+
+	// normal function
+
+	OptimizeResult run(const vector<double>&);
+};
+
+#endif /* LEVENBERG_MARQUARDT_HPP_ */
@@ -0,0 +1,60 @@
+/*
+ * optimizer.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ *
+ * This cord is written by UTF-8
+ */
+
+#ifndef OPTIMIZER_HPP_
+#define OPTIMIZER_HPP_
+
+#include <vector>
+
+using namespace std;
+
+/* 最適化器・評価器とFilterParamの関係
+ *   DifferentialEvolution, CMAES, LevenbergMarquardt, LBFGS, IncrementalEvaluatorは
+ *   構築時に渡したFilterParamを複製せず参照として保持する
+ *   そのため，これらのオブジェクトより先にFilterParamを破棄しないこと
+ */
+
+/* 最適化を終了した理由を示す列挙体
+ *   Target : 目的関数値が目標値以下になった
+ *   Generation : 世代数(反復回数)の上限に達した
+ *   Stagnation : 最良値が指定世代数の間改善しなかった
+ *                (CMA-ESでは再始動の上限に達した後，分布が収束・退化した場合も含む)
+ *   Evaluation : 目的関数の評価回数の上限に達した
+ */
+enum class StopReason
+{
+	Target,
+	Generation,
+	Stagnation,
+	Evaluation
+};
+
+/* 最適化の結果をまとめた構造体
+ *   coef : 最良の係数列
+ *   value : 最良の目的関数値
+ *   generation : 実行した世代数(反復回数)
+ *   nevaluation : 目的関数の評価回数
+ *   stop : 終了した理由
+ *   history : 世代ごとの最良値(history[0]は初期集団，要素数はgeneration + 1)
+ */
+struct OptimizeResult
+{
+	vector<double> coef;
+	double value;
+	unsigned int generation;
+	unsigned long nevaluation;
+	StopReason stop;
+	vector<double> history;
+
+	OptimizeResult()
+	: value(0.0), generation(0), nevaluation(0), stop(StopReason::Generation)
+	{}
+};
+
+#endif /* OPTIMIZER_HPP_ */
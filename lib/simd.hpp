@@ -0,0 +1,146 @@
+/*
+ * simd.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ *
+ * This cord is written by UTF-8
+ */
+
+#ifndef SIMD_HPP_
+#define SIMD_HPP_
+
+#if defined(__AVX512F__) || defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+// GCC 12以前のavx512fintrin.hは_mm512_undefined_pd()の自己初期化により
+// インライン展開先で-W(maybe-)uninitializedの誤検知を出す(GCC PR105593)
+// 抑制はこのヘッダの範囲に限り，末尾で元の警告設定に戻す
+#if defined(__AVX512F__) && defined(__GNUC__) && !defined(__clang__)
+#define SIMD_SUPPRESS_PR105593
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#endif
+
+#include <cmath>
+#include <algorithm>
+
+// カーネルの部品を確実にインライン展開させる指定
+#if defined(__GNUC__)
+#define SIMD_INLINE inline __attribute__((always_inline))
+#else
+#define SIMD_INLINE inline
+#endif
+
+/* 倍精度SIMDレジスタの薄いラッパ
+ *   カーネルは以下の型をテンプレート引数に取り，
+ *   命令セットに依存せず同じ式で記述する
+ *
+ *   SimdScalar : 1要素(スカラー版，フォールバック)
+ *   SimdAvx2   : 4要素(__m256d)  -mavx2 指定時のみ定義
+ *   SimdAvx512 : 8要素(__m512d)  -mavx512f 指定時のみ定義
+ *   SimdNative : コンパイル時に利用可能な最大幅の型
+ *
+ *   load/storeは非整列アドレスを許す
+ */
+struct SimdScalar
+{
+	typedef double reg;
+	static constexpr unsigned int width = 1;
+
+	static reg load(const double* p) { return *p; }
+	static void store(double* p, reg v) { *p = v; }
+	static reg set1(double v) { return v; }
+	static reg zero() { return 0.0; }
+	static reg add(reg a, reg b) { return a + b; }
+	static reg sub(reg a, reg b) { return a - b; }
+	static reg mul(reg a, reg b) { return a*b; }
+	static reg div(reg a, reg b) { return a/b; }
+	static reg fmadd(reg a, reg b, reg c) { return a*b + c; }		// a*b + c
+	static reg fnmadd(reg a, reg b, reg c) { return c - a*b; }		// c - a*b
+	static reg max(reg a, reg b) { return (a < b) ? b : a; }
+	static reg sqrt(reg a) { return std::sqrt(a); }
+	static reg keep_gt(reg a, reg b) { return (a > b) ? a : 0.0; }		// a > b ? a : 0
+	static double hmax(reg a) { return a; }
+	static double hsum(reg a) { return a; }
+};
+
+#if defined(__AVX2__)
+struct SimdAvx2
+{
+	typedef __m256d reg;
+	static constexpr unsigned int width = 4;
+
+	static reg load(const double* p) { return _mm256_loadu_pd(p); }
+	static void store(double* p, reg v) { _mm256_storeu_pd(p, v); }
+	static reg set1(double v) { return _mm256_set1_pd(v); }
+	static reg zero() { return _mm256_setzero_pd(); }
+	static reg add(reg a, reg b) { return _mm256_add_pd(a, b); }
+	static reg sub(reg a, reg b) { return _mm256_sub_pd(a, b); }
+	static reg mul(reg a, reg b) { return _mm256_mul_pd(a, b); }
+	static reg div(reg a, reg b) { return _mm256_div_pd(a, b); }
+#if defined(__FMA__)
+	static reg fmadd(reg a, reg b, reg c) { return _mm256_fmadd_pd(a, b, c); }
+	static reg fnmadd(reg a, reg b, reg c) { return _mm256_fnmadd_pd(a, b, c); }
+#else
+	static reg fmadd(reg a, reg b, reg c) { return _mm256_add_pd(_mm256_mul_pd(a, b), c); }
+	static reg fnmadd(reg a, reg b, reg c) { return _mm256_sub_pd(c, _mm256_mul_pd(a, b)); }
+#endif
+	static reg max(reg a, reg b) { return _mm256_max_pd(a, b); }
+	static reg sqrt(reg a) { return _mm256_sqrt_pd(a); }
+	static reg keep_gt(reg a, reg b) { return _mm256_and_pd(a, _mm256_cmp_pd(a, b, _CMP_GT_OQ)); }
+	static double hmax(reg a)
+	{
+		alignas(32) double v[4];
+		_mm256_store_pd(v, a);
+		return std::max(std::max(v[0], v[1]), std::max(v[2], v[3]));
+	}
+	static double hsum(reg a)
+	{
+		alignas(32) double v[4];
+		_mm256_store_pd(v, a);
+		return (v[0] + v[1]) + (v[2] + v[3]);
+	}
+};
+#endif
+
+#if defined(__AVX512F__)
+struct SimdAvx512
+{
+	typedef __m512d reg;
+	static constexpr unsigned int width = 8;
+
+	static reg load(const double* p) { return _mm512_loadu_pd(p); }
+	static void store(double* p, reg v) { _mm512_storeu_pd(p, v); }
+	static reg set1(double v) { return _mm512_set1_pd(v); }
+	static reg zero() { return _mm512_setzero_pd(); }
+	static reg add(reg a, reg b) { return _mm512_add_pd(a, b); }
+	static reg sub(reg a, reg b) { return _mm512_sub_pd(a, b); }
+	static reg mul(reg a, reg b) { return _mm512_mul_pd(a, b); }
+	static reg div(reg a, reg b) { return _mm512_div_pd(a, b); }
+	static reg fmadd(reg a, reg b, reg c) { return _mm512_fmadd_pd(a, b, c); }
+	static reg fnmadd(reg a, reg b, reg c) { return _mm512_fnmadd_pd(a, b, c); }
+	static reg max(reg a, reg b) { return _mm512_max_pd(a, b); }
+	static reg sqrt(reg a) { return _mm512_sqrt_pd(a); }
+	static reg keep_gt(reg a, reg b) { return _mm512_maskz_mov_pd(_mm512_cmp_pd_mask(a, b, _CMP_GT_OQ), a); }
+	static double hmax(reg a) { return _mm512_reduce_max_pd(a); }
+	static double hsum(reg a) { return _mm512_reduce_add_pd(a); }
+};
+#endif
+
+#if defined(__AVX512F__)
+typedef SimdAvx512 SimdNative;
+#elif defined(__AVX2__)
+typedef SimdAvx2 SimdNative;
+#else
+typedef SimdScalar SimdNative;
+#endif
+
+#if defined(SIMD_SUPPRESS_PR105593)
+#pragma GCC diagnostic pop
+#undef SIMD_SUPPRESS_PR105593
+#endif
+
+#endif /* SIMD_HPP_ */
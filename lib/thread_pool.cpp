@@ -0,0 +1,253 @@
+/*
+ * thread_pool.cpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ */
+
+#include "thread_pool.hpp"
+
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+using namespace std;
+
+// 現在のスレッドがプールのジョブを処理中かどうか(入れ子の並列化によるデッドロックを防ぐ)
+static thread_local bool worker_flag = false;
+
+/* # スレッドプール
+ *   コンストラクタ
+ *
+ * # 引数
+ * unsigned int nthread : 並列数(呼び出し側のスレッドを含む)
+ *                        0の場合はハードウェアの並列数を使う
+ * vector<int> cpus : ワーカーを固定するCPU番号の列(空なら固定しない)
+ */
+ThreadPool::ThreadPool(const unsigned int nthread, const vector<int>& cpus)
+:generation(0), running(0), stop(false),
+ job(nullptr), job_end(0), job_grain(1), job_next(0)
+{
+	start(nthread, cpus);
+}
+
+ThreadPool::~ThreadPool()
+{
+	shutdown();
+}
+
+/* # スレッドプール
+ *   並列数とCPUの割り当てを変更する
+ *   既存のワーカーを終了させてから作り直す
+ *
+ * # 引数
+ * unsigned int nthread : 並列数(呼び出し側のスレッドを含む)
+ *                        0の場合はハードウェアの並列数を使う
+ * vector<int> cpus : ワーカーiをcpus[i % cpus.size()]に固定する(空なら固定しない)
+ */
+void ThreadPool::configure(const unsigned int nthread, const vector<int>& cpus)
+{
+	lock_guard<mutex> job_lock(job_mutex);
+	shutdown();
+	start(nthread, cpus);
+}
+
+void ThreadPool::start(const unsigned int nthread, const vector<int>& cpus)
+{
+	unsigned int n = nthread;
+	if (n == 0)
+	{
+		n = thread::hardware_concurrency();
+		if (n == 0)
+		{
+			n = 1;
+		}
+	}
+
+	// 新しいワーカーは現在の通し番号を処理済みとして始める
+	// (configureで作り直したワーカーが前のジョブの通し番号で起きないようにする)
+	unsigned long seen;
+	{
+		lock_guard<mutex> lock(state_mutex);
+		stop = false;
+		running = 0;
+		seen = generation;
+	}
+	this->cpus = cpus;
+	workers.reserve(n - 1);
+	for (unsigned int i = 0; i < n - 1; ++i)
+	{
+		workers.emplace_back(&ThreadPool::worker_loop, this, i, seen);
+	}
+}
+
+void ThreadPool::shutdown()
+{
+	{
+		lock_guard<mutex> lock(state_mutex);
+		stop = true;
+	}
+	wake.notify_all();
+	for (auto& w : workers)
+	{
+		w.join();
+	}
+	workers.clear();
+}
+
+/* # スレッドプール
+ *   ワーカーの本体
+ *   ジョブの通し番号がseenから進むのを待ち，チャンクが尽きるまで処理する
+ */
+void ThreadPool::worker_loop(const unsigned int index, unsigned long seen)
+{
+	worker_flag = true;
+	if (!cpus.empty() && !set_current_affinity(cpus[index % cpus.size()]))
+	{
+		fprintf(stderr,
+			"Warning: [%s l.%d]Can't set CPU affinity.(worker : %u, cpu : %d)\n",
+			__FILE__, __LINE__, index, cpus[index % cpus.size()]);
+	}
+
+	while (true)
+	{
+		{
+			unique_lock<mutex> lock(state_mutex);
+			wake.wait(lock, [&]{ return stop || generation != seen; });
+			if (stop)
+			{
+				return;
+			}
+			seen = generation;
+		}
+
+		run_chunks();
+
+		{
+			lock_guard<mutex> lock(state_mutex);
+			--running;
+		}
+		done.notify_one();
+	}
+}
+
+void ThreadPool::run_chunks()
+{
+	while (true)
+	{
+		const unsigned int begin = job_next.fetch_add(job_grain, memory_order_relaxed);
+		if (begin >= job_end)
+		{
+			return;
+		}
+		(*job)(begin, min(begin + job_grain, job_end));
+	}
+}
+
+/* # スレッドプール
+ *   区間[begin : end)をgrain個ずつのチャンクに分けて並列に処理する
+ *   呼び出し側のスレッドもチャンクを処理し，全チャンクの完了後に戻る
+ *   処理中のチャンク内から呼ばれた場合(入れ子)は呼び出し側のスレッドだけで処理する
+ *   configureと同時に呼び出してはならない
+ *
+ * # 引数
+ * unsigned int begin : 区間の先頭
+ * unsigned int end : 区間の末尾(この値は含まない)
+ * unsigned int grain : 1チャンクの要素数(0の場合は1)
+ * function<void(unsigned int, unsigned int)> func : チャンク[b : e)を処理する関数
+ */
+void ThreadPool::parallel_for
+(const unsigned int begin, const unsigned int end, const unsigned int grain,
+ const function<void(unsigned int, unsigned int)>& func)
+{
+	if (begin >= end)
+	{
+		return;
+	}
+
+	const unsigned int g = grain == 0 ? 1 : grain;
+	if (workers.empty() || worker_flag || end - begin <= g)
+	{
+		for (unsigned int b = begin; b < end; b += g)
+		{
+			func(b, min(b + g, end));
+		}
+		return;
+	}
+
+	lock_guard<mutex> job_lock(job_mutex);
+	{
+		lock_guard<mutex> lock(state_mutex);
+		job = &func;
+		job_end = end;
+		job_grain = g;
+		job_next.store(begin, memory_order_relaxed);
+		running = workers.size();
+		++generation;
+	}
+	wake.notify_all();
+
+	worker_flag = true;
+	run_chunks();
+	worker_flag = false;
+
+	unique_lock<mutex> lock(state_mutex);
+	done.wait(lock, [&]{ return running == 0; });
+	job = nullptr;
+}
+
+/* # スレッドプール
+ *   プロセス終了まで存続する共有プール
+ *   初回呼び出し時にハードウェアの並列数で生成する
+ */
+ThreadPool& ThreadPool::global()
+{
+	static ThreadPool pool;
+	return pool;
+}
+
+/* # スレッドプール
+ *   現在のスレッドがプールのジョブを処理中であるか
+ */
+bool ThreadPool::in_worker()
+{
+	return worker_flag;
+}
+
+/* # スレッドプール
+ *   現在のスレッドを指定CPUに固定する
+ *   対応していない環境では何もせずfalseを返す
+ */
+bool ThreadPool::set_current_affinity(const int cpu)
+{
+	if (cpu < 0)
+	{
+		return false;
+	}
+#if defined(_WIN32)
+	if (cpu >= (int)(sizeof(DWORD_PTR)*8))
+	{
+		return false;
+	}
+	return SetThreadAffinityMask(GetCurrentThread(), (DWORD_PTR)1 << cpu) != 0;
+#elif defined(__linux__)
+	if (cpu >= CPU_SETSIZE)
+	{
+		return false;
+	}
+	cpu_set_t set;
+	CPU_ZERO(&set);
+	CPU_SET(cpu, &set);
+	return pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &set) == 0;
+#else
+	return false;
+#endif
+}
@@ -0,0 +1,78 @@
+/*
+ * thread_pool.hpp
+ *
+ *  Created on: 2026/10/17
+ *      Author: matsu
+ *
+ * This cord is written by UTF-8
+ */
+
+#ifndef THREAD_POOL_HPP_
+#define THREAD_POOL_HPP_
+
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <functional>
+
+using namespace std;
+
+/* 並列評価用のスレッドプール
+ *   ワーカースレッドを保持し続け，区間[begin : end)の処理を
+ *   grain個ずつのチャンクに分けて呼び出し側のスレッドと共に分担する
+ *   チャンクは共有カウンタから早い者勝ちで取得するため，
+ *   候補ごとに計算時間がばらついても負荷が偏らない
+ *
+ *   global()はプロセス終了まで存続する共有プールを返す
+ *   世代ごとにスレッドを生成しないよう，最適化ではこのプールを使い回す
+ */
+class ThreadPool
+{
+private:
+	vector<thread> workers;
+	vector<int> cpus;			// ワーカーiをcpus[i % cpus.size()]に固定(空なら固定しない)
+
+	mutex job_mutex;			// parallel_forの同時呼び出しを直列化
+	mutex state_mutex;
+	condition_variable wake;
+	condition_variable done;
+	unsigned long generation;	// 投入したジョブの通し番号
+	unsigned int running;		// ジョブ実行中のワーカー数
+	bool stop;
+
+	const function<void(unsigned int, unsigned int)>* job;
+	unsigned int job_end;
+	unsigned int job_grain;
+	atomic<unsigned int> job_next;
+
+	void start(const unsigned int, const vector<int>&);
+	void shutdown();
+	void worker_loop(const unsigned int, unsigned long);
+	void run_chunks();
+
+	static bool set_current_affinity(const int);
+
+public:
+	ThreadPool(const unsigned int nthread = 0, const vector<int>& cpus = vector<int>());
+	~ThreadPool();
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/* # スレッドプール
+	 *   並列数(呼び出し側のスレッドを含む)
+	 */
+	unsigned int size() const
+	{ return workers.size() + 1; }
+
+	void configure(const unsigned int, const vector<int>& cpus = vector<int>());
+	void parallel_for(const unsigned int, const unsigned int, const unsigned int,
+		const function<void(unsigned int, unsigned int)>&);
+
+	static ThreadPool& global();
+	static bool in_worker();
+};
+
+#endif /* THREAD_POOL_HPP_ */
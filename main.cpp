@@ -6,10 +6,23 @@
  */
 
 #include "./lib/filter_param.hpp"
+#include "./lib/simd.hpp"
+#include "./lib/incremental_evaluator.hpp"
+#include "./lib/fft.hpp"
+#include "./lib/cascade_filter.hpp"
+#include "./lib/fixed_point_filter.hpp"
+#include "./lib/differential_evolution.hpp"
+#include "./lib/cma_es.hpp"
+#include "./lib/levenberg_marquardt.hpp"
+#include "./lib/lbfgs.hpp"
 
 #include <stdio.h>
 #include <string>
 #include <chrono>
+#include <functional>
+#include <atomic>
+#include <thread>
+#include <limits>
 
 using namespace std;
 
@@ -19,11 +32,15 @@ void test_analyze_edges();
 void test_FilterParam_read_csv();
 void test_FilterParam_csw();
 void test_FilterParam_desire_res();
+void test_FilterParam_freq_grid();
 void test_FilterParam_freq_res_speed();
 void test_FilterParam_freq_res_se();
 void test_FilterParam_freq_res_so();
 void test_FilterParam_freq_res_no();
 void test_FilterParam_freq_res_mo();
+void test_FilterParam_freq_res_simd();
+void test_FilterParam_freq_res_workspace();
+void test_FilterParam_fixed_order();
 void test_Filter_param_group_delay_se();
 void test_Filter_param_group_delay_so();
 void test_Filter_param_group_delay_no();
@@ -31,6 +48,32 @@ void test_Filter_param_group_delay_mo();
 void test_FilterParam_judge_stability_even();
 void test_FilterParam_judge_stability_odd();
 void test_FilterParam_evaluate_objective_function();
+void test_FilterParam_evaluate_batch();
+void test_FilterParam_evaluate_batch_layout();
+void test_FilterParam_evaluate_fused();
+void test_FilterParam_evaluate_bounded();
+void test_FilterParam_dispatch_speed();
+void test_FilterParam_evaluate_batch_parallel();
+void test_FilterParam_concurrent_const();
+void test_FilterParam_freq_gd_res();
+void test_FilterParam_evaluate_group_delay();
+void test_FilterParam_evaluate_magnitude();
+void test_fft();
+void test_FilterParam_dense_freq_res();
+void test_IncrementalEvaluator();
+void test_CascadeFilter();
+void test_MultiCascadeFilter();
+void test_LiveCascadeFilter();
+void test_CascadeFilter_process_parallel();
+void test_FixedPointCascadeFilter();
+void test_DifferentialEvolution();
+void test_CMAES();
+void test_FilterParam_residual_jacobian();
+void test_LevenbergMarquardt();
+void test_FilterParam_smooth_objective();
+void test_LBFGS();
+void test_FilterParam_stable_param();
+void test_DifferentialEvolution_stable_param();
 void test_FilterParam_init_coef();
 void test_FilterParam_init_stable_coef();
 void test_FilterParam_gprint_amp();
@@ -177,6 +220,32 @@ void test_FilterParam_desire_res()
 
 }
 
+/* # フィルタ構造体
+ *   周波数グリッドの確認用
+ *   帯域ごとの先頭インデックスと，各点の帯域種別・
+ *   複素正弦波・所望特性を出力する
+ */
+void test_FilterParam_freq_grid()
+{
+	auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.3);
+	FilterParam fparam(8, 2, bands, 20, 5, 5.0);
+	const FreqGrid& grid = fparam.freq_grid();
+
+	printf("points : %u, bands : %u\n", grid.size(), grid.nband());
+	printf("alignment : %s\n",
+		(reinterpret_cast<uintptr_t>(grid.csw_re.data()) % 64 == 0) ? "64byte" : "unaligned");
+	for (unsigned int i = 0; i < grid.nband(); ++i)
+	{
+		printf("-----------band %u [%u : %u)-----------------\n", i, grid.band_begin(i), grid.band_end(i));
+		for (unsigned int j = grid.band_begin(i); j < grid.band_end(i); ++j)
+		{
+			printf("%d % 6f % 6f % 6f % 6f % 6f % 6f\n", (int)grid.band_type[j],
+				grid.csw_re[j], grid.csw_im[j], grid.csw2_re[j], grid.csw2_im[j],
+				grid.desire_re[j], grid.desire_im[j]);
+		}
+	}
+}
+
 /* # フィルタ構造体
  *   周波数特性計算関数の実行速度を計算する
  *
@@ -374,6 +443,162 @@ void test_FilterParam_freq_res_mo()
 	}
 }
 
+/* # フィルタ構造体
+ *   SIMDカーネルの周波数特性と，std::complexで1点ずつ
+ *   計算した周波数特性との最大相対誤差を確認する
+ *   4通りの次数の偶奇の組み合わせについて，1e-12以内であること
+ */
+void test_FilterParam_freq_res_simd()
+{
+	printf("simd width : %u\n", SimdNative::width);
+
+	unsigned int orders[][2] = {{8, 2}, {5, 5}, {7, 4}, {8, 3}};
+	for (auto order : orders)
+	{
+		auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.3);
+		FilterParam fparam(order[0], order[1], bands, 200, 50, 5.0);
+		auto coef = fparam.init_stable_coef(0.5, 2.0);
+		auto freq_res = fparam.freq_res(coef);
+		const FreqGrid& grid = fparam.freq_grid();
+
+		double max_error = 0.0;
+		for (unsigned int i = 0; i < grid.nband(); ++i)
+		{
+			for (unsigned int j = grid.band_begin(i); j < grid.band_end(i); ++j)
+			{
+				const complex<double> z1(grid.csw_re[j], grid.csw_im[j]);
+				const complex<double> z2(grid.csw2_re[j], grid.csw2_im[j]);
+				complex<double> nume(1.0, 0.0);
+				complex<double> deno(1.0, 0.0);
+
+				unsigned int n = 1;
+				if ((order[0] % 2) == 1)
+				{
+					nume *= 1.0 + coef.at(1)*z1;
+					n = 2;
+				}
+				for (; n < order[0]; n += 2)
+				{
+					nume *= 1.0 + coef.at(n)*z1 + coef.at(n + 1)*z2;
+				}
+				unsigned int m = order[0] + 1;
+				if ((order[1] % 2) == 1)
+				{
+					deno *= 1.0 + coef.at(m)*z1;
+					m += 1;
+				}
+				for (; m < fparam.opt_order(); m += 2)
+				{
+					deno *= 1.0 + coef.at(m)*z1 + coef.at(m + 1)*z2;
+				}
+				complex<double> expect = coef.at(0)*(nume / deno);
+				double error = abs(expect - freq_res.at(i).at(j - grid.band_begin(i))) / max(abs(expect), 1e-3);
+				max_error = max(max_error, error);
+			}
+		}
+		printf("order(zero/pole) %u/%u : max relative error %e\n", order[0], order[1], max_error);
+	}
+}
+
+/* # フィルタ構造体
+ *   確保済みの領域へ書き込む周波数特性・群遅延計算のテスト
+ *   2回目以降の呼び出しで領域が再確保されず(先頭アドレスが変わらず)，
+ *   戻り値版と同じ値になること
+ */
+void test_FilterParam_freq_res_workspace()
+{
+	auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.275);
+	FilterParam fparam(7, 4, bands, 200, 50, 5.0);
+
+	vector<vector<complex<double>>> freq;
+	vector<vector<double>> gd;
+	FilterWorkspace ws;
+	ws.reserve(fparam.freq_grid().size());
+
+	fparam.freq_res(fparam.init_stable_coef(0.5, 3.0), freq);
+	fparam.group_delay_res(fparam.init_stable_coef(0.5, 3.0), gd);
+	const complex<double>* freq_head = freq.at(0).data();
+	const double* gd_head = gd.at(0).data();
+
+	double max_diff = 0.0;
+	bool reused = true;
+	for (unsigned int k = 0; k < 100; ++k)
+	{
+		auto coef = fparam.init_stable_coef(0.5, 3.0);
+		fparam.freq_res(coef, freq);
+		fparam.group_delay_res(coef, gd);
+		fparam.freq_res(coef.data(), ws.re.data(), ws.im.data());
+		reused = reused && (freq.at(0).data() == freq_head) && (gd.at(0).data() == gd_head);
+
+		auto expect_freq = fparam.freq_res(coef);
+		auto expect_gd = fparam.group_delay_res(coef);
+		const FreqGrid& grid = fparam.freq_grid();
+		for (unsigned int i = 0; i < grid.nband(); ++i)
+		{
+			for (unsigned int j = 0; j < grid.band_size(i); ++j)
+			{
+				const unsigned int p = grid.band_begin(i) + j;
+				max_diff = max(max_diff, abs(expect_freq.at(i).at(j) - freq.at(i).at(j)));
+				max_diff = max(max_diff, abs(expect_freq.at(i).at(j) - complex<double>(ws.re[p], ws.im[p])));
+				max_diff = max(max_diff, abs(expect_gd.at(i).at(j) - gd.at(i).at(j)));
+			}
+		}
+	}
+
+	printf("buffer reused : %s\n", reused ? "yes" : "no");
+	printf("max difference : %e\n", max_diff);
+}
+
+/* # フィルタ構造体
+ *   次数固定カーネルのテスト
+ *   汎用カーネルとの周波数特性・群遅延・目的関数値の差と，
+ *   目的関数の計算時間を比較する
+ */
+void test_FilterParam_fixed_order()
+{
+	unsigned int orders[][2] = {{8, 2}, {5, 5}, {7, 4}, {8, 3}, {16, 14}, {22, 4}};
+	const int repeat = 10000;
+
+	for (auto order : orders)
+	{
+		auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.3);
+		FilterParam fparam(order[0], order[1], bands, 200, 50, 5.0);
+		auto coef = fparam.init_stable_coef(0.5, 2.0);
+		double time[2];
+		double value[2];
+		vector<vector<complex<double>>> freq[2];
+		vector<vector<double>> gd[2];
+
+		for (int fixed = 0; fixed < 2; ++fixed)
+		{
+			fparam.set_fixed_order(fixed == 1);
+			freq[fixed] = fparam.freq_res(coef);
+			gd[fixed] = fparam.group_delay_res(coef);
+
+			auto start = chrono::system_clock::now();
+			for (int k = 0; k < repeat; ++k)
+			{
+				value[fixed] = fparam.evaluate(coef);
+			}
+			auto end = chrono::system_clock::now();
+			time[fixed] = chrono::duration_cast<chrono::nanoseconds>(end - start).count() / (double)repeat;
+		}
+
+		double max_diff = abs(value[0] - value[1]);
+		for (unsigned int i = 0; i < freq[0].size(); ++i)
+		{
+			for (unsigned int j = 0; j < freq[0].at(i).size(); ++j)
+			{
+				max_diff = max(max_diff, abs(freq[0].at(i).at(j) - freq[1].at(i).at(j)));
+				max_diff = max(max_diff, abs(gd[0].at(i).at(j) - gd[1].at(i).at(j)));
+			}
+		}
+
+		printf("order(zero/pole) %2u/%2u : fixed %s, generic %8.1f[ns], fixed %8.1f[ns], max difference %e\n",
+			order[0], order[1], fparam.is_fixed_order() ? "yes" : "no ", time[0], time[1], max_diff);
+	}
+}
+
 void test_Filter_param_group_delay_se()
 {
    vector<double> coef
@@ -732,6 +957,1584 @@ void test_FilterParam_evaluate_objective_function()
 	printf("objective_function_value %f\n",objective_function_value);
 }
 
+/* # フィルタ構造体
+ *   候補解をまとめて評価するテスト
+ *   evaluateを1つずつ呼んだ結果と一致すること
+ */
+void test_FilterParam_evaluate_batch()
+{
+	auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.275);
+	FilterParam fparam(7, 4, bands, 200, 50, 5.0);
+	const unsigned int ncand = 200;
+
+	vector<double> coefs;
+	coefs.reserve(ncand*fparam.opt_order());
+	for (unsigned int k = 0; k < ncand; ++k)
+	{
+		auto coef = fparam.init_coef(0.5, 3.0, 3.0);
+		coefs.insert(coefs.end(), coef.begin(), coef.end());
+	}
+
+	vector<double> values;
+	auto start = chrono::system_clock::now();
+	fparam.evaluate_batch(coefs, values);
+	auto end = chrono::system_clock::now();
+
+	double max_diff = 0.0;
+	for (unsigned int k = 0; k < ncand; ++k)
+	{
+		vector<double> coef(coefs.begin() + k*fparam.opt_order(), coefs.begin() + (k + 1)*fparam.opt_order());
+		max_diff = max(max_diff, abs(fparam.evaluate(coef) - values.at(k)));
+	}
+
+	printf("candidates : %u\n", ncand);
+	printf("batch : %f[us/candidate]\n",
+		chrono::duration_cast<chrono::nanoseconds>(end - start).count() / 1000.0 / ncand);
+	printf("max difference from evaluate : %e\n", max_diff);
+}
+
+/* # フィルタ構造体
+ *   候補解方向(BatchLayout::Candidate)と周波数点方向(BatchLayout::Frequency)の
+ *   evaluate_batchの速度と値の差を，次数と周波数点数を変えて比べる
+ *   BatchLayout::Autoが選んだ方向も表示する
+ */
+void test_FilterParam_evaluate_batch_layout()
+{
+	unsigned int orders[][2] = {{2, 2}, {4, 4}, {8, 6}, {12, 10}, {16, 14}};
+	unsigned int nsplits[][2] = {{10, 5}, {30, 10}, {200, 50}, {1000, 200}};
+	EvalMode modes[] = {EvalMode::Complex, EvalMode::Magnitude};
+	const unsigned int ncand = 400;
+	const unsigned int nrep = 10;
+	auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.275);
+
+	for (auto mode : modes)
+	{
+		for (auto& order : orders)
+		{
+			for (auto& nsplit : nsplits)
+			{
+				FilterParam fparam(order[0], order[1], bands, nsplit[0], nsplit[1], 5.0);
+				fparam.set_eval_mode(mode);
+
+				vector<double> coefs;
+				coefs.reserve(ncand*fparam.opt_order());
+				for (unsigned int k = 0; k < ncand; ++k)
+				{
+					auto coef = fparam.init_coef(0.5, 3.0, 3.0);
+					coefs.insert(coefs.end(), coef.begin(), coef.end());
+				}
+
+				BatchLayout layouts[] = {BatchLayout::Frequency, BatchLayout::Candidate};
+				vector<double> values[2];
+				double time[2];
+				for (unsigned int t = 0; t < 2; ++t)
+				{
+					// 計測のばらつきを避けるためnrep回の最短時間を使う
+					fparam.set_batch_layout(layouts[t]);
+					time[t] = 1.0e30;
+					for (unsigned int rep = 0; rep < nrep; ++rep)
+					{
+						auto start = chrono::system_clock::now();
+						fparam.evaluate_batch(coefs, values[t]);
+						auto end = chrono::system_clock::now();
+						time[t] = min(time[t], chrono::duration_cast<chrono::nanoseconds>(end - start).count() / 1000.0 / ncand);
+					}
+				}
+
+				double max_diff = 0.0;
+				for (unsigned int k = 0; k < ncand; ++k)
+				{
+					max_diff = max(max_diff, abs(values[0].at(k) - values[1].at(k)) / max(1.0, abs(values[0].at(k))));
+				}
+				fparam.set_batch_layout(BatchLayout::Auto);
+
+				printf("%s %2u/%2u, %4u points : frequency %8.3f[us], candidate %8.3f[us], speedup %5.2f, auto %-9s, max difference %e\n",
+					mode == EvalMode::Complex ? "complex  " : "magnitude",
+					order[0], order[1], fparam.freq_grid().size(), time[0], time[1], time[0]/time[1],
+					fparam.use_candidate_lanes() ? "candidate" : "frequency", max_diff);
+			}
+		}
+	}
+}
+
+/* # フィルタ構造体
+ *   周波数特性を保存しない評価(1回の走査)のテスト
+ *   freq_resで周波数特性を求めてから誤差を計算した値と一致すること
+ */
+void test_FilterParam_evaluate_fused()
+{
+	auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.275);
+	FilterParam fparam(7, 4, bands, 2000, 500, 5.0);
+	const FreqGrid& grid = fparam.freq_grid();
+
+	double max_diff = 0.0;
+	for (unsigned int k = 0; k < 100; ++k)
+	{
+		auto coef = fparam.init_stable_coef(0.5, 3.0);
+		auto freq = fparam.freq_res(coef);
+
+		double max_error = 0.0;
+		double max_riple = 0.0;
+		for (unsigned int i = 0; i < grid.nband(); ++i)
+		{
+			for (unsigned int j = grid.band_begin(i); j < grid.band_end(i); ++j)
+			{
+				const complex<double> res = freq.at(i).at(j - grid.band_begin(i));
+				if (grid.band_type[j] == BandType::Transition)
+				{
+					if (abs(res) > 1.0)
+					{
+						max_riple = max(max_riple, abs(res));
+					}
+				}
+				else
+				{
+					max_error = max(max_error, abs(complex<double>(grid.desire_re[j], grid.desire_im[j]) - res));
+				}
+			}
+		}
+		double expect = max_error + 100*max_riple*max_riple + 100*fparam.judge_stability(coef);
+		max_diff = max(max_diff, abs(expect - fparam.evaluate(coef)) / expect);
+	}
+	printf("max relative difference : %e\n", max_diff);
+}
+
+/* # フィルタ構造体
+ *   打ち切り付き評価のテスト
+ *   暫定最良値を閾値として候補解を評価し，
+ *   閾値以下の候補ではevaluateと一致し，閾値を超えた候補では
+ *   evaluateの値も閾値を超えていることを確認する
+ */
+void test_FilterParam_evaluate_bounded()
+{
+	auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.275);
+	FilterParam fparam(7, 4, bands, 200, 50, 5.0);
+	const unsigned int ncand = 2000;
+
+	vector<vector<double>> coefs;
+	for (unsigned int k = 0; k < ncand; ++k)
+	{
+		auto coef = fparam.init_stable_coef(0.5, 3.0);
+		for (auto& c : coef)
+		{
+			c *= 0.1;
+		}
+		coefs.emplace_back(coef);
+	}
+
+	double best = 1.0e10;
+	unsigned int rejected = 0;
+	unsigned int mismatch = 0;
+	auto start1 = chrono::system_clock::now();
+	for (auto& coef : coefs)
+	{
+		double value = fparam.evaluate_bounded(coef, best);
+		if (value > best)
+		{
+			++rejected;
+		}
+		else
+		{
+			best = value;
+		}
+	}
+	auto end1 = chrono::system_clock::now();
+
+	best = 1.0e10;
+	auto start2 = chrono::system_clock::now();
+	for (auto& coef : coefs)
+	{
+		double value = fparam.evaluate(coef);
+		double bounded = fparam.evaluate_bounded(coef, best);
+		if ((value <= best && abs(value - bounded) > 1.0e-12) || (value > best && bounded <= best))
+		{
+			++mismatch;
+		}
+		best = min(best, value);
+	}
+	auto end2 = chrono::system_clock::now();
+
+	printf("rejected : %u / %u\n", rejected, ncand);
+	printf("mismatch : %u\n", mismatch);
+	printf("bounded : %f[us/candidate]\n",
+		chrono::duration_cast<chrono::nanoseconds>(end1 - start1).count() / 1000.0 / ncand);
+	printf("evaluate + bounded : %f[us/candidate]\n",
+		chrono::duration_cast<chrono::nanoseconds>(end2 - start2).count() / 1000.0 / ncand);
+}
+
+/* # フィルタ構造体
+ *   関数呼び出しのオーバーヘッド計測
+ *   従来のstd::function経由の呼び出しと直接呼び出しを比較する
+ */
+void test_FilterParam_dispatch_speed()
+{
+	auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.275);
+	FilterParam fparam(7, 4, bands, 200, 50, 5.0);
+	auto coef = fparam.init_stable_coef(0.5, 3.0);
+	const unsigned int iter = 100000;
+
+	function< double(const FilterParam*, const vector<double>&) > stability_func =
+		[](const FilterParam* fp, const vector<double>& c){ return fp->judge_stability(c); };
+	function< double(const FilterParam*, const vector<double>&) > evaluate_func =
+		[](const FilterParam* fp, const vector<double>& c){ return fp->evaluate(c); };
+	volatile double sink = 0.0;
+
+	auto start = chrono::system_clock::now();
+	for (unsigned int k = 0; k < iter; ++k)
+	{
+		sink = stability_func(&fparam, coef);
+	}
+	auto end = chrono::system_clock::now();
+	printf("judge_stability (std::function) : %f[ns]\n",
+		chrono::duration_cast<chrono::nanoseconds>(end - start).count() / (double)iter);
+
+	start = chrono::system_clock::now();
+	for (unsigned int k = 0; k < iter; ++k)
+	{
+		sink = fparam.judge_stability(coef);
+	}
+	end = chrono::system_clock::now();
+	printf("judge_stability (direct) : %f[ns]\n",
+		chrono::duration_cast<chrono::nanoseconds>(end - start).count() / (double)iter);
+
+	for (bool fixed : {true, false})
+	{
+		fparam.set_fixed_order(fixed);
+		printf("fixed order : %d\n", fparam.is_fixed_order());
+
+		start = chrono::system_clock::now();
+		for (unsigned int k = 0; k < iter; ++k)
+		{
+			sink = evaluate_func(&fparam, coef);
+		}
+		end = chrono::system_clock::now();
+		printf("evaluate (std::function) : %f[ns]\n",
+			chrono::duration_cast<chrono::nanoseconds>(end - start).count() / (double)iter);
+
+		start = chrono::system_clock::now();
+		for (unsigned int k = 0; k < iter; ++k)
+		{
+			sink = fparam.evaluate(coef);
+		}
+		end = chrono::system_clock::now();
+		printf("evaluate (direct) : %f[ns]\n",
+			chrono::duration_cast<chrono::nanoseconds>(end - start).count() / (double)iter);
+	}
+	(void)sink;
+
+	printf("sizeof(FilterParam) : %zu\n", sizeof(FilterParam));
+}
+
+/* # フィルタ構造体
+ *   スレッドプールによる並列評価のテスト
+ *   evaluate_batchと一致すること，並列数ごとの処理時間を表示する
+ */
+void test_FilterParam_evaluate_batch_parallel()
+{
+	auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.275);
+	FilterParam fparam(7, 4, bands, 200, 50, 5.0);
+	const unsigned int ncand = 20000;
+
+	vector<double> coefs;
+	coefs.reserve(ncand*fparam.opt_order());
+	for (unsigned int k = 0; k < ncand; ++k)
+	{
+		auto coef = fparam.init_coef(0.5, 3.0, 3.0);
+		coefs.insert(coefs.end(), coef.begin(), coef.end());
+	}
+
+	vector<double> expect;
+	auto start = chrono::system_clock::now();
+	fparam.evaluate_batch(coefs, expect);
+	auto end = chrono::system_clock::now();
+	printf("serial : %f[us/candidate]\n",
+		chrono::duration_cast<chrono::nanoseconds>(end - start).count() / 1000.0 / ncand);
+
+	const unsigned int nmax = max(4u, ThreadPool::global().size());
+	for (unsigned int nthread = 1; nthread <= nmax; nthread *= 2)
+	{
+		vector<int> cpus;
+		for (unsigned int i = 1; i < nthread; ++i)
+		{
+			cpus.push_back(i % ThreadPool::global().size());
+		}
+		ThreadPool pool(nthread, cpus);
+
+		vector<double> values;
+		start = chrono::system_clock::now();
+		fparam.evaluate_batch_parallel(coefs, values, pool);
+		end = chrono::system_clock::now();
+
+		unsigned int mismatch = 0;
+		for (unsigned int k = 0; k < ncand; ++k)
+		{
+			if (values.at(k) != expect.at(k))
+			{
+				++mismatch;
+			}
+		}
+		printf("threads %2u : %f[us/candidate], mismatch %u\n", pool.size(),
+			chrono::duration_cast<chrono::nanoseconds>(end - start).count() / 1000.0 / ncand, mismatch);
+	}
+
+	vector<double> values;
+	fparam.evaluate_batch_parallel(coefs, values);
+	printf("global pool (%u threads) : mismatch %zu\n", ThreadPool::global().size(),
+		(size_t)(values != expect));
+}
+
+/* # フィルタ構造体
+ *   同一インスタンスに対するconstメンバ関数の同時呼び出しのテスト
+ *   各スレッドの結果が単一スレッドでの結果と一致すること
+ */
+void test_FilterParam_concurrent_const()
+{
+	auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.275);
+	FilterParam fparam(8, 3, bands, 200, 50, 5.0);
+	const unsigned int ncand = 64;
+
+	vector<vector<double>> coefs;
+	vector<double> expect_value;
+	vector<vector<vector<complex<double>>>> expect_freq;
+	vector<vector<vector<double>>> expect_gd;
+	for (unsigned int k = 0; k < ncand; ++k)
+	{
+		coefs.push_back(fparam.init_stable_coef(0.5, 3.0));
+		expect_value.push_back(fparam.evaluate(coefs.back()));
+		expect_freq.push_back(fparam.freq_res(coefs.back()));
+		expect_gd.push_back(fparam.group_delay_res(coefs.back()));
+	}
+
+	ThreadPool pool(max(4u, ThreadPool::global().size()));
+	atomic<unsigned int> mismatch(0);
+	pool.parallel_for(0, ncand*50, 1,
+		[&](unsigned int begin, unsigned int end)
+		{
+			for (unsigned int i = begin; i < end; ++i)
+			{
+				const unsigned int k = i % ncand;
+				const auto& coef = coefs.at(k);
+				if (fparam.evaluate(coef) != expect_value.at(k)
+					|| fparam.evaluate_bounded(coef, expect_value.at(k) + 1.0) != expect_value.at(k)
+					|| fparam.freq_res(coef) != expect_freq.at(k)
+					|| fparam.group_delay_res(coef) != expect_gd.at(k)
+					|| fparam.init_coef(0.5, 3.0, 3.0).size() != fparam.opt_order())
+				{
+					++mismatch;
+				}
+			}
+		});
+
+	printf("threads : %u\n", pool.size());
+	printf("mismatch : %u\n", mismatch.load());
+}
+
+/* # フィルタ構造体
+ *   周波数特性・群遅延の複合カーネルのテスト
+ *   freq_res, group_delay_resとの差，位相の数値微分との差，
+ *   別々に呼ぶ場合との計算時間を4種類の次数の偶奇で比較する
+ */
+void test_FilterParam_freq_gd_res()
+{
+	unsigned int orders[][2] = {{8, 2}, {5, 5}, {7, 4}, {8, 3}};
+	const int repeat = 10000;
+
+	for (auto order : orders)
+	{
+		auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.3);
+		FilterParam fparam(order[0], order[1], bands, 200, 50, 5.0);
+		const FreqGrid& grid = fparam.freq_grid();
+		auto coef = fparam.init_stable_coef(0.5, 2.0);
+
+		vector<vector<complex<double>>> freq;
+		vector<vector<double>> gd;
+		fparam.freq_gd_res(coef, freq, gd);
+		auto expect_freq = fparam.freq_res(coef);
+		auto expect_gd = fparam.group_delay_res(coef);
+
+		// 係数列から直接計算した周波数特性
+		auto direct_res = [&](const double w)
+		{
+			const complex<double> z1 = polar(1.0, -w);
+			complex<double> res = coef.at(0);
+			unsigned int k = 1;
+			if (order[0] % 2 == 1)
+			{
+				res *= 1.0 + coef.at(k++)*z1;
+			}
+			for (unsigned int n = 0; n < order[0]/2; ++n, k += 2)
+			{
+				res *= 1.0 + coef.at(k)*z1 + coef.at(k + 1)*z1*z1;
+			}
+			if (order[1] % 2 == 1)
+			{
+				res /= 1.0 + coef.at(k++)*z1;
+			}
+			for (unsigned int m = 0; m < order[1]/2; ++m, k += 2)
+			{
+				res /= 1.0 + coef.at(k)*z1 + coef.at(k + 1)*z1*z1;
+			}
+			return res;
+		};
+
+		double max_diff = 0.0;
+		double max_numeric = 0.0;
+		const double h = 1.0e-6;
+		for (unsigned int i = 0; i < freq.size(); ++i)
+		{
+			for (unsigned int j = 0; j < freq.at(i).size(); ++j)
+			{
+				max_diff = max(max_diff, abs(freq.at(i).at(j) - expect_freq.at(i).at(j)));
+				max_diff = max(max_diff, abs(gd.at(i).at(j) - expect_gd.at(i).at(j)));
+
+				const unsigned int p = grid.band_begin(i) + j;
+				const double w = -atan2(grid.csw_im[p], grid.csw_re[p]);
+				const double numeric = -arg(direct_res(w + h)*conj(direct_res(w - h))) / (2.0*h);
+				max_numeric = max(max_numeric, abs(gd.at(i).at(j) - numeric));
+			}
+		}
+
+		auto start = chrono::system_clock::now();
+		for (int k = 0; k < repeat; ++k)
+		{
+			fparam.freq_res(coef, expect_freq);
+			fparam.group_delay_res(coef, expect_gd);
+		}
+		auto end = chrono::system_clock::now();
+		const double separate = chrono::duration_cast<chrono::nanoseconds>(end - start).count() / (double)repeat;
+
+		start = chrono::system_clock::now();
+		for (int k = 0; k < repeat; ++k)
+		{
+			fparam.freq_gd_res(coef, freq, gd);
+		}
+		end = chrono::system_clock::now();
+		const double fused = chrono::duration_cast<chrono::nanoseconds>(end - start).count() / (double)repeat;
+
+		printf("order(zero/pole) %2u/%2u : separate %8.1f[ns], fused %8.1f[ns], max difference %e, numerical derivative %e\n",
+			order[0], order[1], separate, fused, max_diff, max_numeric);
+	}
+}
+
+/* # フィルタ構造体
+ *   通過域の群遅延偏差を含む評価方式(EvalMode::GroupDelay)のテスト
+ *   freq_gd_resから求めた値とevaluate, evaluate_boundedが一致すること
+ */
+void test_FilterParam_evaluate_group_delay()
+{
+	unsigned int orders[][2] = {{8, 2}, {5, 5}, {7, 4}, {8, 3}};
+	const int repeat = 10000;
+
+	for (auto order : orders)
+	{
+		auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.3);
+		FilterParam fparam(order[0], order[1], bands, 200, 50, 5.0);
+		const FreqGrid& grid = fparam.freq_grid();
+		fparam.set_eval_mode(EvalMode::GroupDelay);
+		fparam.set_gd_weight(0.01);
+
+		double max_diff = 0.0;
+		double max_bounded_diff = 0.0;
+		vector<double> coef;
+		for (unsigned int k = 0; k < 100; ++k)
+		{
+			coef = fparam.init_stable_coef(0.5, 2.0);
+			vector<vector<complex<double>>> freq;
+			vector<vector<double>> gd;
+			fparam.freq_gd_res(coef, freq, gd);
+
+			double max_error = 0.0;
+			double max_riple = 0.0;
+			double max_gd = 0.0;
+			for (unsigned int i = 0; i < grid.nband(); ++i)
+			{
+				for (unsigned int j = grid.band_begin(i); j < grid.band_end(i); ++j)
+				{
+					const complex<double> res = freq.at(i).at(j - grid.band_begin(i));
+					switch (grid.band_type[j])
+					{
+						case BandType::Pass:
+							max_gd = max(max_gd, abs(gd.at(i).at(j - grid.band_begin(i)) - fparam.gd()));
+							max_error = max(max_error, abs(complex<double>(grid.desire_re[j], grid.desire_im[j]) - res));
+							break;
+						case BandType::Stop:
+							max_error = max(max_error, abs(complex<double>(grid.desire_re[j], grid.desire_im[j]) - res));
+							break;
+						case BandType::Transition:
+							if (abs(res) > 1.0)
+							{
+								max_riple = max(max_riple, abs(res));
+							}
+							break;
+					}
+				}
+			}
+			const double expect = max_error + 0.01*max_gd + 100*max_riple*max_riple + 100*fparam.judge_stability(coef);
+			const double value = fparam.evaluate(coef);
+			max_diff = max(max_diff, abs(expect - value) / expect);
+			max_bounded_diff = max(max_bounded_diff, abs(fparam.evaluate_bounded(coef, value + 1.0) - value) / value);
+		}
+
+		double time[2];
+		for (int mode = 0; mode < 2; ++mode)
+		{
+			fparam.set_eval_mode(mode == 0 ? EvalMode::Complex : EvalMode::GroupDelay);
+			auto start = chrono::system_clock::now();
+			for (int k = 0; k < repeat; ++k)
+			{
+				fparam.evaluate(coef);
+			}
+			auto end = chrono::system_clock::now();
+			time[mode] = chrono::duration_cast<chrono::nanoseconds>(end - start).count() / (double)repeat;
+		}
+
+		printf("order(zero/pole) %2u/%2u : complex %8.1f[ns], group delay %8.1f[ns], max relative difference %e, bounded %e\n",
+			order[0], order[1], time[0], time[1], max_diff, max_bounded_diff);
+	}
+}
+
+/* # フィルタ構造体
+ *   振幅のみの評価方式(EvalMode::Magnitude)のテスト
+ *   power_resが|freq_res|^2と一致すること，evaluate, evaluate_boundedが
+ *   freq_resから求めた振幅誤差と一致することと，複素誤差の評価との計算時間を比較する
+ */
+void test_FilterParam_evaluate_magnitude()
+{
+	unsigned int orders[][2] = {{8, 2}, {5, 5}, {7, 4}, {8, 3}, {16, 14}};
+	const int repeat = 10000;
+
+	for (auto order : orders)
+	{
+		auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.3);
+		FilterParam fparam(order[0], order[1], bands, 200, 50, 5.0);
+		const FreqGrid& grid = fparam.freq_grid();
+		fparam.set_eval_mode(EvalMode::Magnitude);
+
+		double max_power_diff = 0.0;
+		double max_diff = 0.0;
+		double max_bounded_diff = 0.0;
+		vector<double> coef;
+		for (unsigned int k = 0; k < 100; ++k)
+		{
+			coef = fparam.init_coef(0.5, 2.0, 2.0);
+			auto freq = fparam.freq_res(coef);
+			auto power = fparam.power_res(coef);
+
+			double max_error = 0.0;
+			double max_riple = 0.0;
+			for (unsigned int i = 0; i < grid.nband(); ++i)
+			{
+				for (unsigned int j = grid.band_begin(i); j < grid.band_end(i); ++j)
+				{
+					const double amp = abs(freq.at(i).at(j - grid.band_begin(i)));
+					max_power_diff = max(max_power_diff, abs(power.at(i).at(j - grid.band_begin(i)) - amp*amp) / max(1.0, amp*amp));
+					if (grid.band_type[j] == BandType::Transition)
+					{
+						if (amp > 1.0)
+						{
+							max_riple = max(max_riple, amp);
+						}
+					}
+					else
+					{
+						max_error = max(max_error, abs(abs(complex<double>(grid.desire_re[j], grid.desire_im[j])) - amp));
+					}
+				}
+			}
+			const double expect = max_error + 100*max_riple*max_riple + 100*fparam.judge_stability(coef);
+			const double value = fparam.evaluate(coef);
+			max_diff = max(max_diff, abs(expect - value) / expect);
+			max_bounded_diff = max(max_bounded_diff, abs(fparam.evaluate_bounded(coef, value + 1.0) - value) / value);
+		}
+
+		double time[2];
+		for (int mode = 0; mode < 2; ++mode)
+		{
+			fparam.set_eval_mode(mode == 0 ? EvalMode::Complex : EvalMode::Magnitude);
+			auto start = chrono::system_clock::now();
+			for (int k = 0; k < repeat; ++k)
+			{
+				fparam.evaluate(coef);
+			}
+			auto end = chrono::system_clock::now();
+			time[mode] = chrono::duration_cast<chrono::nanoseconds>(end - start).count() / (double)repeat;
+		}
+
+		printf("order(zero/pole) %2u/%2u : complex %8.1f[ns], magnitude %8.1f[ns], power %e, evaluate %e, bounded %e\n",
+			order[0], order[1], time[0], time[1], max_power_diff, max_diff, max_bounded_diff);
+	}
+}
+
+/* # 高速フーリエ変換
+ *   離散フーリエ変換の定義式との差と，逆変換で元に戻ることを確認する
+ */
+void test_fft()
+{
+	random_device rnd;
+	mt19937 mt(rnd());
+	uniform_real_distribution<double> dist(-1.0, 1.0);
+
+	for (unsigned int n = 2; n <= 1024; n *= 4)
+	{
+		vector<double> x(n);
+		for (auto& v : x)
+		{
+			v = dist(mt);
+		}
+
+		vector<complex<double>> spectrum;
+		rfft(x, spectrum);
+
+		double max_diff = 0.0;
+		for (unsigned int k = 0; k <= n/2; ++k)
+		{
+			complex<double> dft(0.0, 0.0);
+			for (unsigned int i = 0; i < n; ++i)
+			{
+				dft += x[i]*polar(1.0, -2.0*M_PI*((k*i) % n)/n);
+			}
+			max_diff = max(max_diff, abs(dft - spectrum.at(k)));
+		}
+
+		vector<complex<double>> z(x.begin(), x.end());
+		fft(z);
+		fft(z, true);
+		double max_inverse = 0.0;
+		for (unsigned int i = 0; i < n; ++i)
+		{
+			max_inverse = max(max_inverse, abs(z.at(i) - x.at(i)));
+		}
+
+		printf("length %5u : difference from DFT %e, inverse %e\n", n, max_diff, max_inverse);
+	}
+}
+
+/* # フィルタ構造体
+ *   密グリッドの周波数特性(dense_freq_res, dense_freq_res_fft)のテスト
+ *   複素数演算で素朴に直接計算した値との最大振幅に対する相対誤差と，計算時間を比較する
+ *   (乱数の係数はシード値で固定)
+ */
+void test_FilterParam_dense_freq_res()
+{
+	unsigned int orders[][2] = {{8, 3}, {16, 16}, {32, 32}, {48, 48}};
+	mt19937 mt(1);
+
+	for (auto order : orders)
+	{
+		auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.3);
+		FilterParam fparam(order[0], order[1], bands, 200, 50, 5.0);
+		auto coef = fparam.init_stable_coef(0.5, 2.0, mt);
+
+		for (unsigned int nfft = 1u << 16; nfft <= (1u << 20); nfft <<= 2)
+		{
+			auto start = chrono::system_clock::now();
+			auto dense = fparam.dense_freq_res(coef, nfft);
+			auto end = chrono::system_clock::now();
+			const double time_dense = chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0;
+
+			start = chrono::system_clock::now();
+			auto dense_fft = fparam.dense_freq_res_fft(coef, nfft);
+			end = chrono::system_clock::now();
+			const double time_fft = chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0;
+
+			// 縦続型のまま全点を直接計算する
+			vector<complex<double>> direct(nfft/2 + 1);
+			start = chrono::system_clock::now();
+			for (unsigned int k = 0; k <= nfft/2; ++k)
+			{
+				const complex<double> z1 = polar(1.0, -2.0*M_PI*k/nfft);
+				complex<double> res = coef.at(0);
+				unsigned int c = 1;
+				if (order[0] % 2 == 1)
+				{
+					res *= 1.0 + coef.at(c++)*z1;
+				}
+				for (unsigned int n = 0; n < order[0]/2; ++n, c += 2)
+				{
+					res *= 1.0 + coef.at(c)*z1 + coef.at(c + 1)*z1*z1;
+				}
+				if (order[1] % 2 == 1)
+				{
+					res /= 1.0 + coef.at(c++)*z1;
+				}
+				for (unsigned int m = 0; m < order[1]/2; ++m, c += 2)
+				{
+					res /= 1.0 + coef.at(c)*z1 + coef.at(c + 1)*z1*z1;
+				}
+				direct.at(k) = res;
+			}
+			end = chrono::system_clock::now();
+			const double time_direct = chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0;
+
+			// 最大振幅に対する相対誤差
+			double max_diff = 0.0, max_diff_fft = 0.0, max_amp = 0.0;
+			for (unsigned int k = 0; k <= nfft/2; ++k)
+			{
+				max_diff = max(max_diff, abs(dense.at(k) - direct.at(k)));
+				max_diff_fft = max(max_diff_fft, abs(dense_fft.at(k) - direct.at(k)));
+				max_amp = max(max_amp, abs(direct.at(k)));
+			}
+
+			printf("order(zero/pole) %2u/%2u, points %7u : dense_freq_res %8.3f[ms] (%e), fft %8.3f[ms] (%e), direct %8.3f[ms]\n",
+				order[0], order[1], nfft/2 + 1, time_dense, max_diff/max_amp,
+				time_fft, max_diff_fft/max_amp, time_direct);
+		}
+	}
+}
+
+/* # 差分評価器
+ *   1つの節を変更する局所探索で，差分評価の値がevaluateと一致することと
+ *   1回の評価時間を比較する
+ */
+void test_IncrementalEvaluator()
+{
+	unsigned int orders[][2] = {{8, 2}, {5, 5}, {7, 4}, {16, 14}};
+	const unsigned int iter = 2000;
+	random_device rnd;
+	mt19937 mt(rnd());
+	normal_distribution<double> step(0.0, 0.05);
+
+	for (auto order : orders)
+	{
+		auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.3);
+		FilterParam fparam(order[0], order[1], bands, 200, 50, 5.0);
+		auto coef = fparam.init_stable_coef(0.5, 2.0);
+		IncrementalEvaluator inc(fparam, coef);
+		uniform_int_distribution<unsigned int> pick(0, inc.nsection() - 1);
+
+		double max_diff = 0.0;
+		double value = inc.evaluate();
+		unsigned int accepted = 0;
+		double time_inc = 0.0;
+		double time_full = 0.0;
+		for (unsigned int t = 0; t < iter; ++t)
+		{
+			const unsigned int k = pick(mt);
+			double c[2];
+			for (unsigned int i = 0; i < inc.section_size(k); ++i)
+			{
+				c[i] = coef.at(inc.section_begin(k) + i) + step(mt);
+			}
+			auto trial = coef;
+			for (unsigned int i = 0; i < inc.section_size(k); ++i)
+			{
+				trial.at(inc.section_begin(k) + i) = c[i];
+			}
+
+			auto start = chrono::system_clock::now();
+			const double inc_value = inc.evaluate_section(k, c);
+			auto mid = chrono::system_clock::now();
+			const double full_value = fparam.evaluate(trial);
+			auto end = chrono::system_clock::now();
+			time_inc += chrono::duration_cast<chrono::nanoseconds>(mid - start).count();
+			time_full += chrono::duration_cast<chrono::nanoseconds>(end - mid).count();
+			max_diff = max(max_diff, abs(inc_value - full_value) / full_value);
+
+			if (inc_value < value)
+			{
+				inc.update_section(k, c);
+				coef = trial;
+				value = inc_value;
+				++accepted;
+			}
+		}
+		max_diff = max(max_diff, abs(inc.evaluate() - fparam.evaluate(coef)) / fparam.evaluate(coef));
+
+		printf("order(zero/pole) %2u/%2u : sections %2u, accepted %4u, incremental %8.1f[ns], full %8.1f[ns], max relative difference %e\n",
+			order[0], order[1], inc.nsection(), accepted, time_inc / iter, time_full / iter, max_diff);
+	}
+}
+
+/* # ストリーミングフィルタ
+ *   インパルス応答が展開した多項式の差分方程式と一致すること，
+ *   ブロックの分け方・1点ずつの処理によらず出力が一致することを確認し，
+ *   長い信号に対する処理速度を測る
+ */
+void test_CascadeFilter()
+{
+	unsigned int orders[][2] = {{8, 3}, {7, 4}, {4, 6}, {16, 14}};
+	const unsigned int length = 1u << 22;
+	random_device rnd;
+	mt19937 mt(rnd());
+	uniform_real_distribution<double> sample(-1.0, 1.0);
+	uniform_int_distribution<unsigned int> block(1, 3000);
+
+	vector<double> signal(length);
+	for (auto& x : signal)
+	{
+		x = sample(mt);
+	}
+
+	for (auto order : orders)
+	{
+		auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.3);
+		FilterParam fparam(order[0], order[1], bands, 200, 50, 5.0);
+		auto coef = fparam.init_stable_coef(0.5, 2.0);
+		CascadeFilter filter(fparam, coef);
+
+		// 展開した多項式の差分方程式によるインパルス応答
+		vector<double> num, den;
+		fparam.expand_poly(coef, num, den);
+		const unsigned int nimp = 1000;
+		vector<double> impulse(nimp, 0.0);
+		impulse.at(0) = 1.0;
+		vector<double> direct(nimp, 0.0);
+		for (unsigned int i = 0; i < nimp; ++i)
+		{
+			double y = 0.0;
+			for (unsigned int k = 0; k < num.size() && k <= i; ++k)
+			{
+				y += num.at(k)*impulse.at(i - k);
+			}
+			for (unsigned int k = 1; k < den.size() && k <= i; ++k)
+			{
+				y -= den.at(k)*direct.at(i - k);
+			}
+			direct.at(i) = y;
+		}
+		filter.process(impulse);
+		double imp_diff = 0.0;
+		for (unsigned int i = 0; i < nimp; ++i)
+		{
+			imp_diff = max(imp_diff, abs(impulse.at(i) - direct.at(i)));
+		}
+
+		// 一括処理
+		auto whole = signal;
+		filter.reset();
+		auto start = chrono::system_clock::now();
+		filter.process(whole);
+		auto end = chrono::system_clock::now();
+		const double time = chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0;
+
+		// ランダムな長さのブロックに分けた処理と1点ずつの処理
+		auto split = signal;
+		filter.reset();
+		for (unsigned int i = 0; i < length; )
+		{
+			const unsigned int n = min(block(mt), length - i);
+			filter.process(split.data() + i, n);
+			i += n;
+		}
+		filter.reset();
+		double split_diff = 0.0;
+		double sample_diff = 0.0;
+		for (unsigned int i = 0; i < length; ++i)
+		{
+			split_diff = max(split_diff, abs(split.at(i) - whole.at(i)));
+			sample_diff = max(sample_diff, abs(filter.process(signal.at(i)) - whole.at(i)));
+		}
+
+		printf("order(zero/pole) %2u/%2u : sections %2u, impulse difference %e, split difference %e, sample difference %e, %8.3f[ms] (%7.1f[Msample/s])\n",
+			order[0], order[1], filter.nsection(), imp_diff, split_diff, sample_diff,
+			time, length / time / 1000.0);
+	}
+}
+
+/* # 多チャネルストリーミングフィルタ
+ *   インターリーブ形式・プレーナ形式の出力がチャネルごとのCascadeFilterと一致することを確認し，
+ *   チャネルごとに1チャネル版を回した場合と処理速度を比較する
+ */
+void test_MultiCascadeFilter()
+{
+	unsigned int nchannels[] = {1, 8, 13, 64};
+	const unsigned int length = 1u << 16;
+	random_device rnd;
+	mt19937 mt(rnd());
+	uniform_real_distribution<double> sample(-1.0, 1.0);
+
+	auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.3);
+	FilterParam fparam(9, 6, bands, 200, 50, 5.0);
+	auto coef = fparam.init_stable_coef(0.5, 2.0);
+	printf("lane width %u\n", MultiCascadeFilter::lane_width());
+
+	for (auto nch : nchannels)
+	{
+		vector<vector<double>> planar(nch, vector<double>(length));
+		for (auto& ch : planar)
+		{
+			for (auto& x : ch)
+			{
+				x = sample(mt);
+			}
+		}
+		vector<double> interleaved(nch*length);
+		for (unsigned int i = 0; i < length; ++i)
+		{
+			for (unsigned int c = 0; c < nch; ++c)
+			{
+				interleaved.at(i*nch + c) = planar.at(c).at(i);
+			}
+		}
+
+		// チャネルごとに1チャネル版で処理する
+		auto single = planar;
+		auto start = chrono::system_clock::now();
+		for (auto& ch : single)
+		{
+			CascadeFilter filter(fparam, coef);
+			filter.process(ch);
+		}
+		auto end = chrono::system_clock::now();
+		const double time_single = chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0;
+
+		MultiCascadeFilter multi(fparam, coef, nch);
+		start = chrono::system_clock::now();
+		multi.process_interleaved(interleaved);
+		end = chrono::system_clock::now();
+		const double time_inter = chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0;
+
+		multi.reset();
+		start = chrono::system_clock::now();
+		multi.process_planar(planar);
+		end = chrono::system_clock::now();
+		const double time_planar = chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0;
+
+		double diff_inter = 0.0;
+		double diff_planar = 0.0;
+		for (unsigned int c = 0; c < nch; ++c)
+		{
+			for (unsigned int i = 0; i < length; ++i)
+			{
+				diff_inter = max(diff_inter, abs(interleaved.at(i*nch + c) - single.at(c).at(i)));
+				diff_planar = max(diff_planar, abs(planar.at(c).at(i) - single.at(c).at(i)));
+			}
+		}
+
+		printf("channels %2u : single %8.3f[ms], interleaved %8.3f[ms], planar %8.3f[ms], max difference %e / %e\n",
+			nch, time_single, time_inter, time_planar, diff_inter, diff_planar);
+	}
+}
+
+/* # 差し替え可能なストリーミングフィルタ
+ *   途中で係数を差し替えたとき，十分後の出力が新しい係数のフィルタと一致することと
+ *   差し替え直後の出力の段差を確認する
+ *   また，別スレッドから係数を送り続けながら処理できることを確認する
+ *   (乱数の係数はシード値で固定)
+ */
+void test_LiveCascadeFilter()
+{
+	const unsigned int length = 1u << 16;
+	auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.3);
+	FilterParam fparam(6, 4, bands, 200, 50, 5.0);
+	mt19937 mt(1);
+	auto coef_a = fparam.init_stable_coef(0.5, 2.0, mt);
+	auto coef_b = fparam.init_stable_coef(0.5, 2.0, mt);
+
+	vector<double> signal(length);
+	for (unsigned int i = 0; i < length; ++i)
+	{
+		signal.at(i) = sin(0.01*i) + 0.5*sin(0.37*i);
+	}
+	auto reference = signal;
+	CascadeFilter filter_b(fparam, coef_b);
+	filter_b.process(reference);
+
+	unsigned int crossfades[] = {0, 256};
+	for (auto crossfade : crossfades)
+	{
+		LiveCascadeFilter live(fparam, coef_a, crossfade);
+		auto output = signal;
+		const unsigned int half = length/2;
+		const unsigned int block = 64;
+		for (unsigned int i = 0; i < length; i += block)
+		{
+			if (i == half)
+			{
+				live.publish(coef_b);
+			}
+			live.process(output.data() + i, block);
+		}
+
+		double max_step = 0.0;
+		for (unsigned int i = half; i < half + 2*block; ++i)
+		{
+			max_step = max(max_step, abs(output.at(i) - output.at(i - 1)));
+		}
+		double steady_diff = 0.0;
+		for (unsigned int i = length - length/4; i < length; ++i)
+		{
+			steady_diff = max(steady_diff, abs(output.at(i) - reference.at(i)));
+		}
+		printf("crossfade %3u : swaps %lu, max step after swap %e, steady-state difference %e\n",
+			crossfade, live.nswap(), max_step, steady_diff);
+	}
+
+	// 送信側のスレッドが係数を送り続ける間に処理する
+	LiveCascadeFilter live(fparam, coef_a, 64);
+	atomic<bool> finish(false);
+	unsigned int published = 0;
+	thread producer([&]
+	{
+		while (!finish.load())
+		{
+			live.publish(published % 2 == 0 ? coef_b : coef_a);
+			++published;
+			this_thread::sleep_for(chrono::microseconds(50));
+		}
+	});
+	bool finite = true;
+	auto output = signal;
+	for (unsigned int rep = 0; rep < 16; ++rep)
+	{
+		output = signal;
+		for (unsigned int i = 0; i < length; i += 64)
+		{
+			live.process(output.data() + i, 64);
+		}
+		for (auto y : output)
+		{
+			finite = finite && isfinite(y);
+		}
+	}
+	finish.store(true);
+	producer.join();
+	printf("concurrent : published %u, swaps %lu, finite %s\n",
+		published, live.nswap(), finite ? "true" : "false");
+}
+
+/* # ストリーミングフィルタ
+ *   長い信号のブロック並列処理の結果が逐次処理と許容誤差内で一致することを確認する
+ *   信号を2回に分けて渡し，呼び出しをまたいだ状態の引き継ぎも確認する
+ *   (乱数の係数と信号はシード値で固定)
+ */
+void test_CascadeFilter_process_parallel()
+{
+	const unsigned int length = 1u << 24;
+	mt19937 mt(1);
+	uniform_real_distribution<double> sample(-1.0, 1.0);
+
+	auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.3);
+	FilterParam fparam(9, 6, bands, 200, 50, 5.0);
+	auto coef = fparam.init_stable_coef(0.5, 2.0, mt);
+
+	vector<double> signal(length);
+	for (auto& x : signal)
+	{
+		x = sample(mt);
+	}
+
+	auto sequential = signal;
+	CascadeFilter filter_seq(fparam, coef);
+	auto start = chrono::system_clock::now();
+	filter_seq.process(sequential);
+	auto end = chrono::system_clock::now();
+	const double time_seq = chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0;
+
+	// 1コアの環境でもブロック分割の経路を通るよう4スレッド以上のプールを使う
+	ThreadPool pool(max(4u, thread::hardware_concurrency()));
+	auto parallel = signal;
+	CascadeFilter filter_par(fparam, coef);
+	const unsigned int half = length/2 + 12345;
+	start = chrono::system_clock::now();
+	filter_par.process_parallel(parallel.data(), half, pool);
+	filter_par.process_parallel(parallel.data() + half, length - half, pool);
+	end = chrono::system_clock::now();
+	const double time_par = chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0;
+
+	double max_diff = 0.0;
+	double max_out = 0.0;
+	for (unsigned int i = 0; i < length; ++i)
+	{
+		max_diff = max(max_diff, abs(parallel.at(i) - sequential.at(i)));
+		max_out = max(max_out, abs(sequential.at(i)));
+	}
+
+	printf("threads %u : sequential %8.3f[ms], parallel %8.3f[ms], max difference %e (relative %e)\n",
+		pool.size(), time_seq, time_par, max_diff, max_diff/max_out);
+}
+
+/* # 固定小数点ストリーミングフィルタ
+ *   量子化した係数の周波数特性の偏差と，倍精度のCascadeFilterとの出力の差を確認する
+ */
+template <typename T>
+void test_FixedPointCascadeFilter_type(const FilterParam& fparam, const vector<double>& coef, const char* name)
+{
+	const unsigned int length = 1u << 16;
+	const double full_scale = (double)numeric_limits<T>::max();
+
+	FixedPointCascadeFilter<T> filter(fparam, coef);
+	auto res = fparam.freq_res(coef);
+	auto res_q = fparam.freq_res(filter.quantized_coef());
+	double max_dev = 0.0;
+	for (unsigned int i = 0; i < res.size(); ++i)
+	{
+		for (unsigned int j = 0; j < res.at(i).size(); ++j)
+		{
+			max_dev = max(max_dev, abs(res.at(i).at(j) - res_q.at(i).at(j)));
+		}
+	}
+
+	// 倍精度のフィルタの出力との差を信号対雑音比で表す
+	vector<double> signal(length);
+	vector<T> input(length);
+	for (unsigned int i = 0; i < length; ++i)
+	{
+		signal.at(i) = 0.45*sin(0.05*i) + 0.45*sin(1.3*i);
+		input.at(i) = (T)round(signal.at(i)*full_scale);
+	}
+	CascadeFilter reference(fparam, coef);
+	reference.process(signal);
+
+	auto start = chrono::system_clock::now();
+	filter.process(input);
+	auto end = chrono::system_clock::now();
+
+	double power = 0.0;
+	double noise = 0.0;
+	for (unsigned int i = 0; i < length; ++i)
+	{
+		const double e = input.at(i)/full_scale - signal.at(i);
+		power += signal.at(i)*signal.at(i);
+		noise += e*e;
+	}
+
+	printf("%s : sections %u, max response deviation %e, SNR %6.2f[dB], %f[ns/sample]\n",
+		name, filter.nsection(), max_dev, 10.0*log10(power/noise),
+		chrono::duration_cast<chrono::nanoseconds>(end - start).count() / (double)length);
+}
+
+void test_FixedPointCascadeFilter()
+{
+	auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.3);
+	FilterParam fparam(9, 6, bands, 200, 50, 5.0);
+
+	// シード値を固定した差分進化で設計した低域通過フィルタを使い，結果を再現できるようにする
+	DEParam de_param;
+	de_param.population = 64;
+	de_param.max_generation = 400;
+	de_param.seed = 1;
+	auto coef = DifferentialEvolution(fparam, de_param).run().coef;
+
+	// 振幅特性の最大値を1に揃え，出力が飽和しないようにする
+	double peak = 0.0;
+	for (auto& band : fparam.freq_res(coef))
+	{
+		for (auto& h : band)
+		{
+			peak = max(peak, abs(h));
+		}
+	}
+	coef.at(0) /= peak;
+
+	test_FixedPointCascadeFilter_type<int16_t>(fparam, coef, "int16");
+	test_FixedPointCascadeFilter_type<int32_t>(fparam, coef, "int32");
+}
+
+/* # 差分進化
+ *   2つの変異戦略で最適化し，世代ごとの最良値の推移を確認する
+ *   同じシード値で再実行した結果が一致することと，
+ *   vector<vector<double>>とevaluateで書いた素朴な差分進化との所要時間を比べる
+ */
+void test_DifferentialEvolution()
+{
+	auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.275);
+	FilterParam fparam(8, 6, bands, 200, 50, 5.0);
+
+	DEParam param;
+	param.population = 64;
+	param.max_generation = 500;
+	param.stagnation = 100;
+	param.seed = 1;
+
+	DEStrategy strategies[] = {DEStrategy::Rand1Bin, DEStrategy::CurrentToBest1Bin};
+	const char* names[] = {"rand/1/bin", "current-to-best/1/bin"};
+	double time_library = 0.0;
+	for (unsigned int s = 0; s < 2; ++s)
+	{
+		param.strategy = strategies[s];
+		DifferentialEvolution de(fparam, param);
+		auto start = chrono::system_clock::now();
+		OptimizeResult result = de.run();
+		auto end = chrono::system_clock::now();
+		const double time = chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0;
+		if (s == 0)
+		{
+			time_library = time / result.generation;
+		}
+
+		OptimizeResult again = DifferentialEvolution(fparam, param).run();
+		printf("%-22s : generations %4u, evaluations %6lu, best %e, %9.3f[ms], reproducible %s, stop %d\n",
+			names[s], result.generation, result.nevaluation, result.value, time,
+			(again.value == result.value && again.coef == result.coef) ? "true" : "false", (int)result.stop);
+		for (unsigned int g = 0; g <= result.generation; g += 100)
+		{
+			printf("  generation %4u : %e\n", g, result.history.at(g));
+		}
+	}
+
+	// 素朴な差分進化(rand/1/bin)の1世代あたりの時間
+	mt19937 mt(1);
+	uniform_real_distribution<> unit(0.0, 1.0);
+	uniform_int_distribution<unsigned int> pick(0, param.population - 1);
+	vector<vector<double>> population;
+	vector<double> value;
+	for (unsigned int k = 0; k < param.population; ++k)
+	{
+		population.push_back(fparam.init_stable_coef(0.5, 3.0, mt));
+		value.push_back(fparam.evaluate(population.back()));
+	}
+	const unsigned int naive_generation = 100;
+	auto start = chrono::system_clock::now();
+	for (unsigned int g = 0; g < naive_generation; ++g)
+	{
+		for (unsigned int i = 0; i < param.population; ++i)
+		{
+			unsigned int r0, r1, r2;
+			do { r0 = pick(mt); } while (r0 == i);
+			do { r1 = pick(mt); } while (r1 == i || r1 == r0);
+			do { r2 = pick(mt); } while (r2 == i || r2 == r0 || r2 == r1);
+			vector<double> trial = population.at(i);
+			for (unsigned int j = 0; j < trial.size(); ++j)
+			{
+				if (unit(mt) < param.crossover)
+				{
+					trial.at(j) = population.at(r0).at(j) + param.scale*(population.at(r1).at(j) - population.at(r2).at(j));
+				}
+			}
+			const double v = fparam.evaluate(trial);
+			if (v <= value.at(i))
+			{
+				population.at(i) = trial;
+				value.at(i) = v;
+			}
+		}
+	}
+	auto end = chrono::system_clock::now();
+	const double time_naive = chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0 / naive_generation;
+	printf("per generation : library %f[ms], naive loop %f[ms], speedup %5.2f (threads %u)\n",
+		time_library, time_naive, time_naive/time_library, ThreadPool::global().size());
+}
+
+/* # CMA-ES
+ *   差分進化の世代ごとの最良値から目標値を決め，
+ *   CMA-ES(再始動なし・IPOP・BIPOP)が目標値に達するまでの評価回数を差分進化と比べる
+ *   差分進化と同じ評価回数を使い切ったときの最良値も表示する
+ */
+void test_CMAES()
+{
+	struct Spec { unsigned int n, m; double pass, stop, nd; };
+	Spec specs[] = {{8, 6, 0.2, 0.275, 5.0}, {16, 14, 0.3, 0.35, 15.0}};
+	CMARestart restarts[] = {CMARestart::None, CMARestart::IPOP, CMARestart::BIPOP};
+	const char* names[] = {"CMA-ES", "IPOP-CMA-ES", "BIPOP-CMA-ES"};
+
+	for (auto& spec : specs)
+	{
+		auto bands = FilterParam::gen_bands(FilterType::LPF, spec.pass, spec.stop);
+		FilterParam fparam(spec.n, spec.m, bands, 200, 50, spec.nd);
+
+		DEParam de_param;
+		de_param.population = 64;
+		de_param.max_generation = 1000;
+		de_param.seed = 1;
+		OptimizeResult de = DifferentialEvolution(fparam, de_param).run();
+
+		// 差分進化が最終的な最良値に初めて達した評価回数
+		const double target = de.value;
+		unsigned int g = 0;
+		while (de.history.at(g) > target)
+		{
+			++g;
+		}
+		printf("order %u/%u : target %e\n", spec.n, spec.m, target);
+		printf("  %-14s : evaluations %7lu\n", "DE rand/1/bin", (unsigned long)de_param.population*(g + 1));
+
+		for (unsigned int r = 0; r < 3; ++r)
+		{
+			CMAESParam param;
+			param.restart = restarts[r];
+			param.target = target;
+			param.max_evaluation = (unsigned long)de_param.population*(de_param.max_generation + 1);
+			param.seed = 1;
+			auto start = chrono::system_clock::now();
+			OptimizeResult result = CMAES(fparam, param).run();
+			auto end = chrono::system_clock::now();
+			const double time = chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0;
+			printf("  %-14s : evaluations %7lu, generations %5u, best %e, %9.3f[ms], stop %d\n",
+				names[r], result.nevaluation, result.generation, result.value, time, (int)result.stop);
+
+			// 差分進化と同じ評価回数を使い切ったときの最良値(再始動の効果)
+			param.target = 0.0;
+			OptimizeResult budget = CMAES(fparam, param).run();
+			printf("  %-14s   same budget : best %e, stop %d\n", "", budget.value, (int)budget.stop);
+		}
+	}
+}
+
+/* # フィルタ構造体
+ *   残差とヤコビ行列のテスト
+ *   4種類の次数の偶奇について，残差がfreq_resと所望特性の差に，
+ *   ヤコビ行列が中心差分に一致すること
+ */
+void test_FilterParam_residual_jacobian()
+{
+	auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.275);
+	const unsigned int orders[][2] = {{8, 6}, {7, 5}, {7, 6}, {8, 5}};
+	mt19937 mt(1);
+
+	for (auto& order : orders)
+	{
+		FilterParam fparam(order[0], order[1], bands, 200, 50, 5.0);
+		const FreqGrid& grid = fparam.freq_grid();
+		const unsigned int npoint = grid.size();
+		vector<double> coef = fparam.init_stable_coef(0.5, 3.0, mt);
+
+		vector<double> res, jac;
+		fparam.residual_jacobian(coef, res, jac);
+
+		vector<double> re(npoint), im(npoint);
+		fparam.freq_res(coef.data(), re.data(), im.data());
+		double res_error = 0.0;
+		for (unsigned int j = 0; j < npoint; ++j)
+		{
+			res_error = max(res_error, abs(res[j] - (re[j] - grid.desire_re[j])));
+			res_error = max(res_error, abs(res[npoint + j] - (im[j] - grid.desire_im[j])));
+		}
+
+		// 中心差分との相対誤差
+		double jac_error = 0.0;
+		const double h = 1.0e-6;
+		vector<double> plus(2*npoint), minus(2*npoint), dummy(fparam.opt_order()*2*npoint);
+		for (unsigned int k = 0; k < fparam.opt_order(); ++k)
+		{
+			vector<double> cp = coef, cm = coef;
+			cp[k] += h;
+			cm[k] -= h;
+			fparam.residual_jacobian(cp.data(), plus.data(), dummy.data());
+			fparam.residual_jacobian(cm.data(), minus.data(), dummy.data());
+			double scale = 0.0, diff = 0.0;
+			for (unsigned int j = 0; j < 2*npoint; ++j)
+			{
+				const double numeric = (plus[j] - minus[j])/(2.0*h);
+				scale = max(scale, abs(numeric));
+				diff = max(diff, abs(numeric - jac[(size_t)k*2*npoint + j]));
+			}
+			jac_error = max(jac_error, diff/scale);
+		}
+		printf("order %u/%u : residual error %e, jacobian relative error %e\n",
+			order[0], order[1], res_error, jac_error);
+	}
+}
+
+/* # Levenberg-Marquardt法
+ *   差分進化の途中結果を局所改良し，同じ評価回数を差分進化に追加した場合と比べる
+ */
+void test_LevenbergMarquardt()
+{
+	struct Spec { unsigned int n, m; double pass, stop, nd; };
+	Spec specs[] = {{8, 6, 0.2, 0.275, 5.0}, {16, 14, 0.3, 0.35, 15.0}};
+
+	for (auto& spec : specs)
+	{
+		auto bands = FilterParam::gen_bands(FilterType::LPF, spec.pass, spec.stop);
+		FilterParam fparam(spec.n, spec.m, bands, 200, 50, spec.nd);
+
+		DEParam de_param;
+		de_param.population = 64;
+		de_param.max_generation = 400;
+		de_param.seed = 1;
+		OptimizeResult de = DifferentialEvolution(fparam, de_param).run();
+
+		for (bool lawson : {false, true})
+		{
+			LMParam param;
+			param.lawson = lawson;
+			auto start = chrono::system_clock::now();
+			OptimizeResult result = LevenbergMarquardt(fparam, param).run(de.coef);
+			auto end = chrono::system_clock::now();
+			const double time = chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0;
+			printf("order %2u/%2u, lawson %-5s : DE %e -> LM %e, evaluations %3lu, iterations %2u, %8.3f[ms], stop %d\n",
+				spec.n, spec.m, lawson ? "true" : "false", de.value, result.value,
+				result.nevaluation, result.generation, time, (int)result.stop);
+		}
+
+		// 差分進化をさらに続けた場合
+		de_param.max_generation = 800;
+		OptimizeResult longer = DifferentialEvolution(fparam, de_param).run();
+		printf("order %2u/%2u, DE continued : %e, evaluations %lu more\n",
+			spec.n, spec.m, longer.value, longer.nevaluation - de.nevaluation);
+	}
+}
+
+/* # フィルタ構造体
+ *   滑らかな目的関数のテスト
+ *   勾配が中心差分に一致することと，pを大きくするとevaluateに近づくことを確認する
+ */
+void test_FilterParam_smooth_objective()
+{
+	auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.275);
+	const unsigned int orders[][2] = {{8, 6}, {7, 5}, {7, 6}, {8, 5}};
+	mt19937 mt(1);
+
+	for (auto& order : orders)
+	{
+		FilterParam fparam(order[0], order[1], bands, 200, 50, 5.0);
+		fparam.set_threshold_riple(0.5);
+		vector<double> coef = fparam.init_stable_coef(0.5, 3.0, mt);
+		vector<double> grad, dummy;
+
+		printf("order %u/%u : evaluate %e\n", order[0], order[1], fparam.evaluate(coef));
+		for (unsigned int log2p : {1u, 4u, 8u, 16u})
+		{
+			const double value = fparam.smooth_objective(coef, log2p, grad);
+
+			// 中心差分との相対誤差
+			const double h = 1.0e-6;
+			double diff = 0.0, scale = 0.0;
+			for (unsigned int k = 0; k < coef.size(); ++k)
+			{
+				vector<double> cp = coef, cm = coef;
+				cp[k] += h;
+				cm[k] -= h;
+				const double numeric = (fparam.smooth_objective(cp, log2p, dummy)
+					- fparam.smooth_objective(cm, log2p, dummy))/(2.0*h);
+				diff = max(diff, abs(numeric - grad[k]));
+				scale = max(scale, abs(numeric));
+			}
+			printf("  p = %6u : value %e, gradient relative error %e\n", 1u << log2p, value, diff/scale);
+		}
+	}
+}
+
+/* # L-BFGS法
+ *   差分進化の途中結果を局所最適化し，Levenberg-Marquardt法と比べる
+ */
+void test_LBFGS()
+{
+	struct Spec { unsigned int n, m; double pass, stop, nd; };
+	Spec specs[] = {{8, 6, 0.2, 0.275, 5.0}, {16, 14, 0.3, 0.35, 15.0}};
+
+	for (auto& spec : specs)
+	{
+		auto bands = FilterParam::gen_bands(FilterType::LPF, spec.pass, spec.stop);
+		FilterParam fparam(spec.n, spec.m, bands, 200, 50, spec.nd);
+
+		DEParam de_param;
+		de_param.population = 64;
+		de_param.max_generation = 400;
+		de_param.seed = 1;
+		OptimizeResult de = DifferentialEvolution(fparam, de_param).run();
+
+		auto start = chrono::system_clock::now();
+		OptimizeResult result = LBFGS(fparam).run(de.coef);
+		auto end = chrono::system_clock::now();
+		const double time = chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0;
+		OptimizeResult lm = LevenbergMarquardt(fparam).run(de.coef);
+		printf("order %2u/%2u : DE %e -> L-BFGS %e (evaluations %4lu, iterations %3u, %8.3f[ms], stable %s, stop %d), LM %e (evaluations %3lu)\n",
+			spec.n, spec.m, de.value, result.value, result.nevaluation, result.generation, time,
+			fparam.judge_stability(result.coef) == 0.0 ? "true" : "false", (int)result.stop,
+			lm.value, lm.nevaluation);
+	}
+}
+
+/* # フィルタ構造体
+ *   安定化変数の写像のテスト
+ *   大きな値を含む乱数の安定化変数がすべて安定な係数列に写ること，
+ *   写した係数列の往復(coef_to_stable，stable_to_coef)の誤差，
+ *   evaluate_stable(_batch)とevaluateの値の差を表示する
+ */
+void test_FilterParam_stable_param()
+{
+	auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.275);
+	const unsigned int orders[][2] = {{8, 6}, {7, 5}, {16, 14}};
+	const unsigned int ncand = 1000;
+	mt19937 mt(1);
+	normal_distribution<> wide(0.0, 10.0);
+	normal_distribution<> narrow(0.0, 2.0);
+
+	for (auto& order : orders)
+	{
+		FilterParam fparam(order[0], order[1], bands, 200, 50, 5.0);
+		const unsigned int dim = fparam.opt_order();
+
+		unsigned int unstable = 0, unstable_direct = 0;
+		double round_trip = 0.0, eval_diff = 0.0;
+		vector<double> params(ncand*dim), values(ncand);
+		for (unsigned int k = 0; k < ncand; ++k)
+		{
+			vector<double> param(dim);
+			for (auto& q : param)
+			{
+				q = wide(mt);
+			}
+			copy(param.begin(), param.end(), params.begin() + k*dim);
+			if (fparam.judge_stability(fparam.stable_to_coef(param)) > 0.0)
+			{
+				++unstable;
+			}
+			if (fparam.judge_stability(fparam.init_coef(0.5, 3.0, 3.0, mt)) > 0.0)
+			{
+				++unstable_direct;
+			}
+
+			for (auto& q : param)
+			{
+				q = narrow(mt);
+			}
+			vector<double> coef = fparam.stable_to_coef(param);
+			vector<double> back = fparam.stable_to_coef(fparam.coef_to_stable(coef));
+			for (unsigned int i = 0; i < dim; ++i)
+			{
+				round_trip = max(round_trip, abs(back[i] - coef[i]));
+			}
+		}
+
+		fparam.evaluate_stable_batch(params.data(), ncand, values.data());
+		for (unsigned int k = 0; k < ncand; ++k)
+		{
+			vector<double> param(params.begin() + k*dim, params.begin() + (k + 1)*dim);
+			const double value = fparam.evaluate(fparam.stable_to_coef(param));
+			eval_diff = max(eval_diff, abs(fparam.evaluate_stable(param) - value)/value);
+			eval_diff = max(eval_diff, abs(values[k] - value)/value);
+		}
+
+		printf("order %2u/%2u : unstable %u/%u (init_coef %u/%u), round trip error %e, evaluate relative difference %e\n",
+			order[0], order[1], unstable, ncand, unstable_direct, ncand, round_trip, eval_diff);
+	}
+}
+
+/* # 差分進化
+ *   係数列の空間と安定化変数の空間(DEParam::stable_param)での探索を，
+ *   シード値を変えた5回の平均値と最良値で比べる
+ */
+void test_DifferentialEvolution_stable_param()
+{
+	struct Spec { unsigned int n, m; double pass, stop, nd; };
+	Spec specs[] = {{8, 6, 0.2, 0.275, 5.0}, {16, 14, 0.3, 0.35, 15.0}};
+
+	for (auto& spec : specs)
+	{
+		auto bands = FilterParam::gen_bands(FilterType::LPF, spec.pass, spec.stop);
+		FilterParam fparam(spec.n, spec.m, bands, 200, 50, spec.nd);
+
+		DEParam param;
+		param.population = 64;
+		param.max_generation = 400;
+		for (bool stable_param : {false, true})
+		{
+			param.stable_param = stable_param;
+			const unsigned int nseed = 5;
+			double mean = 0.0, best = numeric_limits<double>::max(), max_diff = 0.0;
+			bool stable = true;
+			auto start = chrono::system_clock::now();
+			for (unsigned int seed = 1; seed <= nseed; ++seed)
+			{
+				param.seed = seed;
+				OptimizeResult result = DifferentialEvolution(fparam, param).run();
+				mean += result.value/nseed;
+				best = min(best, result.value);
+				max_diff = max(max_diff, abs(fparam.evaluate(result.coef) - result.value));
+				stable = stable && fparam.judge_stability(result.coef) == 0.0;
+			}
+			auto end = chrono::system_clock::now();
+			const double time = chrono::duration_cast<chrono::microseconds>(end - start).count() / 1000.0 / nseed;
+			printf("order %2u/%2u, %-12s : mean %e, best %e (difference from evaluate %e, stable %s, %8.3f[ms/run])\n",
+				spec.n, spec.m, stable_param ? "stable_param" : "coefficient",
+				mean, best, max_diff, stable ? "true" : "false", time);
+		}
+	}
+}
+
 void test_FilterParam_init_coef()
 {
 	auto bands = FilterParam::gen_bands(FilterType::LPF, 0.2, 0.3);